@@ -1,42 +1,129 @@
-#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <string>
+#include <numeric>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "input.h"
+#include "parallel.h"
+#include "topk.h"
 
-using namespace std::string_literals;
-class Elf {
-public:
-	unsigned int getTotalCalories() const {
-		return totalCalories;
+// A line of one to eight digits, parsed eight bytes at a time (SWAR): shift the digits to the top
+// of the word so the missing leading ones read as zeroes, then fold neighbours into 2, 4 and 8 digit numbers.
+// Anything else (too long, too close to the end of the buffer, not all digits) is left to the caller
+std::optional<uint64_t> parseShortNumber(std::string_view buffer, size_t start, size_t length) {
+	if(length == 0 || length > 8 || start + 8 > buffer.size()) {
+		return std::nullopt;
+	}
+	uint64_t word = 0;
+	std::memcpy(&word, buffer.data() + start, 8); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	const uint64_t lineMask = ~uint64_t{0} >> (8 * (8 - length));
+	// a digit has a high nibble of 3, and adding 6 doesn't carry out of its low nibble
+	bool allDigits = ((word & 0xF0F0F0F0F0F0F0F0ULL & lineMask) == (0x3030303030303030ULL & lineMask)) &&
+	                 (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL & lineMask) == (0x3030303030303030ULL & lineMask));
+	if(!allDigits) {
+		return std::nullopt;
 	}
+	word -= 0x3030303030303030ULL;
+	word <<= 8 * (8 - length);
+	word = (word * 10 + (word >> 8U)) & 0x00FF00FF00FF00FFULL;
+	word = (word * 100 + (word >> 16U)) & 0x0000FFFF0000FFFFULL;
+	word = (word * 10000 + (word >> 32U)) & 0xFFFFFFFFULL;
+	return word;
+}
 
-	friend std::istream& operator>>(std::istream& stream, Elf& elf) {
-		while(stream.good()) {
-			std::string calorieCount;
-			std::getline(stream, calorieCount);
-			if (calorieCount.empty()) {
-				break; // hit a space
+// Calls emit(total) for every blank-line-separated group of numbers in the buffer.
+// No strings and no getline: SSE2 finds the newlines 16 bytes at a time, parseShortNumber
+// reads each line's digits eight at a time and they go straight into the running group total
+template <typename Emit>
+void forEachGroupTotal(std::string_view buffer, Emit emit) {
+	uint64_t groupTotal = 0;
+	bool inGroup = false;
+	size_t lineStart = 0;
+	auto endLine = [&](size_t lineEnd) {
+		auto number = parseShortNumber(buffer, lineStart, lineEnd - lineStart).value_or(0);
+		bool hasDigits = number != 0;
+		if(!hasDigits) {
+			// the slow way round for anything odd, like a \r or a long number
+			for(auto c: buffer.substr(lineStart, lineEnd - lineStart)) {
+				if(c >= '0' && c <= '9') {
+					number = number * 10 + static_cast<uint64_t>(c - '0');
+					hasDigits = true;
+				}
 			}
-			elf.totalCalories += std::stoi(calorieCount);
 		}
-		return stream;
+		if(hasDigits) {
+			groupTotal += number;
+			inGroup = true;
+		}
+		else if(inGroup) {
+			emit(groupTotal);
+			groupTotal = 0;
+			inGroup = false;
+		}
+		lineStart = lineEnd + 1;
+	};
+
+	size_t index = 0;
+#ifdef __SSE2__
+	const __m128i newline = _mm_set1_epi8('\n');
+	for(; index + sizeof(__m128i) <= buffer.size(); index += sizeof(__m128i)) {
+		auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer.data() + index)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		auto newlines = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+		for(; newlines != 0; newlines &= newlines - 1) {
+			endLine(index + static_cast<size_t>(std::countr_zero(newlines)));
+		}
 	}
+#endif
+	for(; index < buffer.size(); ++index) {
+		if(buffer[index] == '\n') {
+			endLine(index);
+		}
+	}
+	if(lineStart < buffer.size()) {
+		endLine(buffer.size());
+	}
+	if(inGroup) {
+		emit(groupTotal);
+	}
+}
 
-	friend auto operator<=>(const Elf& elf1, const Elf& elf2) = default;
+// the k biggest group totals, biggest first
+// big buffers are cut at blank lines and every piece gets its own heap on the thread pool
+std::vector<uint64_t> getTopCalories(std::string_view buffer, size_t k) {
+	constexpr size_t minimumChunkSize = 1U << 20U;
+	auto& pool = parallel::getPool();
+	auto numberOfChunks = std::min(pool.size() * 4, buffer.size() / minimumChunkSize + 1);
 
+	std::vector<size_t> boundaries {0};
+	for(size_t chunk = 1; chunk < numberOfChunks; ++chunk) {
+		auto blankLine = buffer.find("\n\n", std::max(boundaries.back(), chunk * buffer.size() / numberOfChunks));
+		if(blankLine == std::string_view::npos) {
+			break;
+		}
+		boundaries.push_back(blankLine + 1);
+	}
+	boundaries.push_back(buffer.size());
 
-private:
-	unsigned int totalCalories = 0U;
-};
+	return topk::parallelTopK<uint64_t>(boundaries.size() - 1, k, [&](size_t chunk, auto push) {
+		forEachGroupTotal(buffer.substr(boundaries[chunk], boundaries[chunk + 1] - boundaries[chunk]), push);
+	}, {}, pool).getSorted();
+}
 
 int main() {
-	auto elves = input::readLines<Elf>("input/input1.txt");
+	auto buffer = input::readFile("input/input1.txt").value_or("");
+	auto topCalories = getTopCalories(buffer, 3);
 
-	std::ranges::sort(elves, std::ranges::greater());
-	std::cout << "The elf with the most calories is: " << elves[0].getTotalCalories() << "\n";
+	std::cout << "The elf with the most calories is: " << (topCalories.empty() ? 0 : topCalories.front()) << "\n";
 
-	auto calorieTotal = elves[0].getTotalCalories() + elves[1].getTotalCalories() + elves[2].getTotalCalories();
+	auto calorieTotal = std::accumulate(topCalories.begin(), topCalories.end(), uint64_t{0});
 	std::cout << "The three elves with the most calories is: " << calorieTotal << "\n";
 
 	return 0;
@@ -4,19 +4,20 @@
 #include <istream>
 #include <iostream>
 #include <ranges>
-#include <set>
 
 #include "grid.h"
+#include "hash.h"
 #include "input.h"
+#include "parallel.h"
 
 
 unsigned int findShortestPathFrom(const auto& grid, Grid::Coord start, Grid::Coord end){
-    std::set<Grid::Coord> seen {start};
-    std::set<Grid::Coord> currentPositions {start};
+    hash::FlatSet<Grid::Coord> seen {start};
+    hash::FlatSet<Grid::Coord> currentPositions {start};
 
     unsigned int steps = 0;
     while(currentPositions.find(end) == currentPositions.end()){
-        std::set<Grid::Coord> newPositions;
+        hash::FlatSet<Grid::Coord> newPositions;
         for(auto position: currentPositions) {
             auto neighbors = grid.getNeighbors(position);
             for(auto& neighbor: neighbors){
@@ -39,10 +40,10 @@ unsigned int findShortestPathFrom(const auto& grid, Grid::Coord start, Grid::Coo
 }
 
 unsigned int findShortestPathFrom(const auto& grid, std::vector<Grid::Coord> startCoords, Grid::Coord end){
-    auto shortestPaths = std::views::transform(startCoords, [&grid, end](const auto& start){
-        return findShortestPathFrom(grid, start, end);
-    }); 
-    return *std::ranges::min_element(shortestPaths);
+    // each start point is its own search, so spread them over the thread pool
+    return parallel::parallelReduce(0, startCoords.size(), UINT32_MAX, [&grid, &startCoords, end](size_t index){
+        return findShortestPathFrom(grid, startCoords[index], end);
+    }, [](unsigned int lhs, unsigned int rhs){ return std::min(lhs, rhs); });
 }
 
 unsigned int getShortestPath(const auto& oldGrid){
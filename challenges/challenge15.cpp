@@ -4,9 +4,12 @@
 #include <ranges>
 #include <regex>
 #include <span>
+#include <utility>
+#include <vector>
 
 #include <grid.h>
 #include <input.h>
+#include <intervals.h>
 
 struct Sensor {
     Grid::Coord sensor;
@@ -78,34 +81,55 @@ unsigned int getNumberOfInvalidPositions(std::span<Sensor> sensors, int row) {
     return count;
 }
 
-unsigned long findSensorTuningFrequency(std::vector<Sensor> sensors){
-    std::ranges::sort(sensors, [](const auto& s1, const auto& s2) { return s1.sensor.xPos < s2.sensor.xPos; });
-    for(int row = 0; row < 4'000'000; ++row){
-        std::vector<std::pair<long, long>> sortedRanges;
-        auto sensorPair = [row](const auto& sensor){ return std::make_pair(sensor.getMinXInRangeAtRow(row), sensor.getMaxXInRangeAtRow(row)); };
-        std::ranges::copy(std::views::transform(sensors, sensorPair), std::back_inserter(sortedRanges));
-        std::ranges::sort(sortedRanges);
-
-        long min = 0;
-        for(auto& range: sortedRanges) { 
-            if (range.second < 0){
-                continue;
-            }
-            
-            if(range.first > 4'000'000){
-               break;  
-            }
-            if(range.first <= min + 1){
-                min = std::max(range.second, min);
-            }
-            else {
-                // there is a gap
-                assert(range.first == min + 2);
-                return static_cast<unsigned long>(range.first-1) * 4'000'000 + row;
+// A sensor's range moves in by at most one on each side from one row to the next, so if every
+// range shrunk by k on both sides still covers [0, limit], the next k rows are covered too.
+// Largest such k, found by doubling then bisecting, all in the one reused set
+long getRowsStillCovered(const std::vector<std::pair<long, long>>& ranges, long limit, intervals::IntervalSet<long>& covered){
+    auto coversAfterShrinking = [&](long shrink){
+        covered.clear();
+        for(auto [minX, maxX]: ranges){
+            covered.insert(minX + shrink, maxX - shrink);
+        }
+        return !covered.getFirstGap(0, limit);
+    };
+    long good = 0;
+    long bad = 1;
+    while(bad <= limit && coversAfterShrinking(bad)){
+        good = bad;
+        bad *= 2;
+    }
+    while(bad - good > 1){
+        auto middle = good + (bad - good) / 2;
+        (coversAfterShrinking(middle) ? good : bad) = middle;
+    }
+    return good;
+}
 
+// Rows aren't all rebuilt from scratch: every row that gets built also tells us how many
+// after it can't have a gap, and those get skipped without building them
+unsigned long findSensorTuningFrequency(const std::vector<Sensor>& sensors, long limit = 4'000'000){
+    // the same set gets reused for every row, so after the first one nothing gets allocated
+    intervals::IntervalSet<long> covered;
+    std::vector<std::pair<long, long>> ranges;
+    for(long row = 0; row <= limit; ++row){
+        ranges.clear();
+        for(const auto& sensor: sensors){
+            auto minX = sensor.getMinXInRangeAtRow(row);
+            auto maxX = sensor.getMaxXInRangeAtRow(row);
+            if(minX <= maxX){
+                ranges.emplace_back(minX, maxX);
             }
         }
 
+        covered.clear();
+        for(auto [minX, maxX]: ranges){
+            covered.insert(minX, maxX);
+        }
+        auto gap = covered.getFirstGap(0, limit);
+        if(gap){
+            return static_cast<unsigned long>(*gap) * 4'000'000 + static_cast<unsigned long>(row);
+        }
+        row += getRowsStillCovered(ranges, limit, covered);
     }
     assert(false);
     return 0;
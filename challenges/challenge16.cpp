@@ -2,7 +2,6 @@
 #include <cassert>
 #include <iostream>
 #include <istream>
-#include <map>
 #include <numeric>
 #include <regex>
 #include <set>
@@ -10,8 +9,9 @@
 #include <tuple>
 #include <unordered_map>
 
-
+#include "hash.h"
 #include "input.h"
+#include "search.h"
 
 struct Valve {
     unsigned long flowRate = 0;
@@ -49,81 +49,80 @@ struct Position {
     }
 };
 
-void insertRate(auto& newPositions, const Position& key, unsigned int newRate){
-    try {
-        auto oldRate = newPositions.at(key);
-        newPositions[key] = std::max(oldRate, newRate);
+template <>
+struct hash::Hash<Position> {
+    uint64_t operator()(const Position& position) const {
+        return hash::hashValues(position.valve, position.elephantValve, position.openValves);
     }
-    catch(...) {
-        newPositions.emplace(std::make_pair(std::move(key), newRate));
+};
+
+// every valve still closed gets opened right now, nothing can release more than that
+unsigned int getUpperBound(const RoomLookup& roomLookup, const Position& position, unsigned int totalFlow, unsigned int minutesLeft){
+    unsigned int closedFlow = 0;
+    for(const auto& [name, valve]: roomLookup){
+        if(!position.isValveOpen(name)){
+            closedFlow += valve.flowRate;
+        }
     }
-    
+    return totalFlow + minutesLeft * closedFlow;
 }
 
-
 unsigned int getMaximumPressure(const RoomLookup& roomLookup) {
     const std::string starting = "AA";
-    std::map<Position, unsigned int> positions {{{starting, "", std::set<std::string>{} }, 0U}};
+    search::LevelSearch<Position, unsigned int> positions {Position{starting, "", std::set<std::string>{} }, 0U};
     for(auto minutes = 1U; minutes <= 30; ++minutes){
-        std::map<Position, unsigned int> newPositions{positions.begin(), positions.end()};
-        for(const auto& current: positions){
-            auto [position, totalFlow] = current;
+        auto expand = [&roomLookup, minutes](const Position& position, unsigned int totalFlow, auto& emit){
+            // standing still is always an option
+            emit(position, totalFlow);
 
-            auto room = roomLookup.at(position.valve);
+            const auto& room = roomLookup.at(position.valve);
             if(room.flowRate != 0 && !position.isValveOpen(position.valve) ) {
                 unsigned int newRate = totalFlow + (30 - minutes) * room.flowRate;
                 auto openValves = position.openValves;
                 openValves.insert(position.valve);
-                // if the new rate is actually greater than the existing position, add it
-                auto key = Position{position.valve, "", std::move(openValves)};
-                insertRate(newPositions, key, newRate);
+                emit(Position{position.valve, "", std::move(openValves)}, newRate);
             }
             for(const auto& tunnel: room.tunnels){
-                auto key = Position{tunnel, "", position.openValves};
-                insertRate(newPositions, key, totalFlow);
+                emit(Position{tunnel, "", position.openValves}, totalFlow);
             }
-        }
-        std::swap(positions, newPositions);
+        };
+        auto bound = [&roomLookup, minutes](const Position& position, unsigned int totalFlow){
+            return getUpperBound(roomLookup, position, totalFlow, 30 - minutes);
+        };
+        positions.advance(expand, bound);
     }
-    return std::ranges::max_element(positions, [](const auto& position1, const auto& position2){
-        return position1.second < position2.second;
-    })->second;
+    return positions.getBest();
 }
 
 unsigned int getMaximumPressureWithElephant(const RoomLookup& roomLookup) {
     const std::string starting = "AA";
     const std::string elephant = "AA";
-    std::map<Position, unsigned int> positions {{{starting, elephant, std::set<std::string>{} }, 0U}};
+    search::LevelSearch<Position, unsigned int> positions {Position{starting, elephant, std::set<std::string>{} }, 0U};
     for(auto minutes = 1U; minutes <= 26; ++minutes){
-        std::map<Position, unsigned int> newPositions{positions.begin(), positions.end()};
-        for(const auto& current: positions){
-            auto [position, totalFlow] = current;
+        auto expand = [&roomLookup, minutes](const Position& position, unsigned int totalFlow, auto& emit){
+            emit(position, totalFlow);
 
-            auto room = roomLookup.at(position.valve);
-            auto elephantRoom = roomLookup.at(position.elephantValve);
+            const auto& room = roomLookup.at(position.valve);
+            const auto& elephantRoom = roomLookup.at(position.elephantValve);
             // four things can happen - we both can open a valve
             // one can move and the other can open a valve (or vice versa)
             // or we both move
             bool isMyValveOpen = (room.flowRate != 0 && !position.isValveOpen(position.valve) );
             bool isElephantValveOpen = (elephantRoom.flowRate != 0 && !position.isValveOpen(position.elephantValve) );
-            auto myTunnels = room.tunnels;
-            auto elephantTunnels = elephantRoom.tunnels;
 
             if(isMyValveOpen && isElephantValveOpen && position.valve != position.elephantValve){
                 unsigned int newRate = totalFlow + (26 - minutes) * (room.flowRate + elephantRoom.flowRate);
                 auto openValves = position.openValves;
                 openValves.insert(position.valve);
                 openValves.insert(position.elephantValve);
-                auto key = Position{position.valve, position.elephantValve, std::move(openValves)};
-                insertRate(newPositions, key, newRate); 
+                emit(Position{position.valve, position.elephantValve, std::move(openValves)}, newRate);
             }
             else if(isMyValveOpen){
                 unsigned int newRate = totalFlow + (26 - minutes) * (room.flowRate);
                 auto openValves = position.openValves;
                 openValves.insert(position.valve);
                 for(const auto& tunnel: elephantRoom.tunnels){
-                    auto key = Position{position.valve, tunnel, openValves};
-                    insertRate(newPositions, key, newRate); 
+                    emit(Position{position.valve, tunnel, openValves}, newRate);
                 }
             }
             else if(isElephantValveOpen){
@@ -131,25 +130,23 @@ unsigned int getMaximumPressureWithElephant(const RoomLookup& roomLookup) {
                 auto openValves = position.openValves;
                 openValves.insert(position.elephantValve);
                 for(const auto& tunnel: room.tunnels){
-                    auto key = Position{tunnel, position.elephantValve, openValves};
-                    insertRate(newPositions, key, newRate); 
+                    emit(Position{tunnel, position.elephantValve, openValves}, newRate);
                 }
             }
             else {
                 for(const auto& tunnel: room.tunnels){
                     for(const auto& elephantTunnel: elephantRoom.tunnels){
-                        auto key = Position{tunnel, elephantTunnel, position.openValves};
-                        insertRate(newPositions, key, totalFlow); 
-
+                        emit(Position{tunnel, elephantTunnel, position.openValves}, totalFlow);
                     }
                 }
             }
-        }
-        std::swap(positions, newPositions);
+        };
+        auto bound = [&roomLookup, minutes](const Position& position, unsigned int totalFlow){
+            return getUpperBound(roomLookup, position, totalFlow, 26 - minutes);
+        };
+        positions.advance(expand, bound);
     }
-    return std::ranges::max_element(positions, [](const auto& position1, const auto& position2){
-        return position1.second < position2.second;
-    })->second;
+    return positions.getBest();
 }
 
 int main() {
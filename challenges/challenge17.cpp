@@ -1,13 +1,16 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
 #include <iostream>
-#include <map>
 #include <ranges>
 #include <set>
 #include <span>
 #include <tuple>
+#include <utility>
+#include <vector>
 
+#include "cycle.h"
 #include "input.h"
 
 struct Shape {
@@ -178,61 +181,101 @@ void placeShape(auto leftEdge, auto bottomEdge, const auto& shape, auto& spaces)
     }
 }
 
-unsigned long getHeightAfterTurns(const std::vector<Direction>& directions, unsigned long turns){
-
-    unsigned long offsetHeight = 0UL;
-    auto shapeIter = shapes.begin();
-    auto directionIter = directions.begin();
+// only the rows a falling rock could still reach are kept, everything under them is just a count
+struct Chamber {
     std::vector<std::array<bool, 7>> spaces { {true, true, true, true, true, true, true} };
-    std::map<std::tuple<Shape*, const Direction*, std::array<unsigned int, 7>>, std::pair<unsigned long, unsigned long>> seen;
-    for(unsigned long turn = 0; turn < turns; ++turn){
-        auto shape = *shapeIter++;
-
-        auto bottomEdge = spaces.size() + 3;
-        auto leftEdge = 2;
-
-        bool shapeStillFalling = true;
-        while(shapeStillFalling){
-            auto direction = *directionIter++;
-            if(directionIter == directions.end()){
-                directionIter = directions.begin();
-            }
-            if(direction == Direction::Left) {
-                leftEdge = shiftLeftIfAble(leftEdge, bottomEdge, shape, spaces);
-            } 
-            if(direction == Direction::Right) {
-                leftEdge = shiftRightIfAble(leftEdge, bottomEdge, shape, spaces); 
-            }
+    size_t trimmedRows = 0;
+    size_t shapeIndex = 0;
+    size_t directionIndex = 0;
+};
 
-            auto newBottom = shiftDownIfAble(leftEdge, bottomEdge, shape, spaces);
-            if(newBottom != bottomEdge){
-                bottomEdge = newBottom;
-            }
-            else {
-                shapeStillFalling = false;
-                placeShape(leftEdge, bottomEdge, shape, spaces);
+// Flood fill the empty cells that connect to the open air above the stack. A rock only ever
+// sits in those, so every row below the lowest one (bar the row it would land on) can go
+void trimUnreachableRows(Chamber& chamber){
+    auto& spaces = chamber.spaces;
+    std::vector<std::array<bool, 7>> reached(spaces.size());
+    std::vector<std::pair<size_t, size_t>> toVisit;
+    for(size_t column = 0; column < 7; ++column){
+        if(!spaces.back()[column]){
+            reached.back()[column] = true;
+            toVisit.emplace_back(spaces.size() - 1, column);
+        }
+    }
+    size_t lowest = spaces.size();
+    while(!toVisit.empty()){
+        auto [row, column] = toVisit.back();
+        toVisit.pop_back();
+        lowest = std::min(lowest, row);
+        auto visit = [&](size_t nextRow, size_t nextColumn){
+            if(!spaces[nextRow][nextColumn] && !reached[nextRow][nextColumn]){
+                reached[nextRow][nextColumn] = true;
+                toVisit.emplace_back(nextRow, nextColumn);
             }
+        };
+        if(row > 0){
+            visit(row - 1, column);
+        }
+        if(column > 0){
+            visit(row, column - 1);
         }
-        auto seenKey = std::make_tuple(&shape, &(*directionIter), getContours(spaces));
-        auto match = seen.find(seenKey);
-        if(match != seen.end()){
-            auto difference = turn - match->second.first;
-            auto differenceOfHeight = (spaces.size() - 1) - match->second.second;
-            auto numberOfRounds = (turns - difference) / difference;
-            turn += numberOfRounds * difference;
-            offsetHeight = numberOfRounds * differenceOfHeight; 
-            
-            seen.clear();
+        if(column < 6){
+            visit(row, column + 1);
         }
+    }
+    auto rowsToTrim = lowest - 1;
+    spaces.erase(spaces.begin(), spaces.begin() + static_cast<std::ptrdiff_t>(rowsToTrim));
+    chamber.trimmedRows += rowsToTrim;
+}
+
+void dropRock(Chamber& chamber, const std::vector<Direction>& directions){
+    auto& spaces = chamber.spaces;
+    const auto& shape = shapes[chamber.shapeIndex];
+    chamber.shapeIndex = (chamber.shapeIndex + 1) % shapes.size();
 
-        seen[seenKey] = {turn, spaces.size() - 1}; 
+    auto bottomEdge = spaces.size() + 3;
+    auto leftEdge = 2;
+
+    bool shapeStillFalling = true;
+    while(shapeStillFalling){
+        auto direction = directions[chamber.directionIndex];
+        chamber.directionIndex = (chamber.directionIndex + 1) % directions.size();
+        if(direction == Direction::Left) {
+            leftEdge = shiftLeftIfAble(leftEdge, bottomEdge, shape, spaces);
+        } 
+        if(direction == Direction::Right) {
+            leftEdge = shiftRightIfAble(leftEdge, bottomEdge, shape, spaces); 
+        }
 
-        if(shapeIter == shapes.end()){
-            shapeIter = shapes.begin();
+        auto newBottom = shiftDownIfAble(leftEdge, bottomEdge, shape, spaces);
+        if(newBottom != bottomEdge){
+            bottomEdge = newBottom;
         }
+        else {
+            shapeStillFalling = false;
+            placeShape(leftEdge, bottomEdge, shape, spaces);
+        }
+    }
+    trimUnreachableRows(chamber);
+}
 
-    } 
-    return offsetHeight + spaces.size() - 1;
+unsigned long getHeightAfterTurns(const std::vector<Direction>& directions, unsigned long turns){
+    auto step = [&directions](Chamber& chamber){ dropRock(chamber, directions); };
+    // the next shape, the next jet and the shape of the surface decide everything that happens from here on
+    auto fingerprint = [](const Chamber& chamber){
+        return std::make_tuple(chamber.shapeIndex, chamber.directionIndex, getContours(chamber.spaces));
+    };
+    auto height = [](const Chamber& chamber){ return chamber.trimmedRows + chamber.spaces.size() - 1; };
+
+    const Chamber chamber;
+    // no point looking for a cycle past the turns we were asked about, just simulate them instead
+    if(auto detected = cycle::brent(chamber, step, fingerprint, height, turns)){
+        return cycle::extrapolate(chamber, step, height, *detected, turns);
+    }
+    Chamber simulated = chamber;
+    for(unsigned long turn = 0; turn < turns; ++turn){
+        step(simulated);
+    }
+    return height(simulated);
 }
 
 int main() {
@@ -4,9 +4,9 @@
 #include <istream>
 #include <ranges>
 #include <span>
-#include <set>
 #include <vector>
 
+#include "hash.h"
 #include "input.h"
 
 using namespace std::literals;
@@ -44,6 +44,13 @@ struct Cube {
 
 };
 
+template <>
+struct hash::Hash<Cube> {
+    uint64_t operator()(const Cube& cube) const {
+        return hash::hashValues(cube.xPos, cube.yPos, cube.zPos);
+    }
+};
+
 unsigned int getExposedFaces(std::span<Cube> cubes){
     std::vector<Cube> seenCubes;
     unsigned int exposedFaces = 0;
@@ -82,7 +89,7 @@ unsigned int getExternallyExposedFaces(std::span<Cube> cubes){
         maxY = std::max(maxY, cube.yPos);
         maxZ = std::max(maxZ, cube.zPos);
     }
-    std::set<Cube> cubeLookup { cubes.begin(), cubes.end() };
+    hash::FlatSet<Cube> cubeLookup { cubes.begin(), cubes.end() };
     // check from all 8 corners in case we're segmented
     std::vector<Cube> spacesToCheck{
         {minX, minY, minZ},
@@ -96,7 +103,7 @@ unsigned int getExternallyExposedFaces(std::span<Cube> cubes){
         {maxX, maxY, maxZ},
     
     };
-    std::set<Cube> seen;
+    hash::FlatSet<Cube> seen;
     unsigned int externallyExposedFaces = 0;
     while(!spacesToCheck.empty()){
         Cube current = *spacesToCheck.rbegin();
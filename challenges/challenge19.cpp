@@ -5,10 +5,12 @@
 #include <numeric>
 #include <regex>
 #include <span>
-#include <map>
 #include <ranges>
 
+#include "hash.h"
 #include "input.h"
+#include "parallel.h"
+#include "search.h"
 
 struct Robots { 
     unsigned int obsidian = 0;
@@ -28,11 +30,13 @@ struct State {
     State(unsigned int obsidian, unsigned int clay, unsigned int ore, Robots robots) :obsidianCollected(obsidian), clayCollected(clay), oreCollected(ore), robots(std::move(robots)) { }
     std::strong_ordering operator<=>(const State& state) const = default;
 };
-void addToStatesMap(auto& newStates, const auto& state, const auto& geodes)
-{
-    newStates.try_emplace(state, geodes);
-    newStates[state] = std::max(newStates[state], geodes);
-}
+
+template <>
+struct hash::Hash<State> {
+    uint64_t operator()(const State& state) const {
+        return hash::hashValues(state.obsidianCollected, state.clayCollected, state.oreCollected, state.robots.obsidian, state.robots.clay, state.robots.ore);
+    }
+};
 
 struct Blueprint {
     unsigned long id = 0;
@@ -62,76 +66,70 @@ struct Blueprint {
     }
 
     unsigned int getGeodes(unsigned int minutes) const {
-        std::map<State, unsigned int> states{{State {0, 0, 0, { 0, 0, 1}}, 0U}};
+        // we can only spend so much of a resource per minute, so there's no point having more robots than that
+        const auto maxOreCost = std::max({oreRobotOreCost, clayRobotOreCost, obsidianRobotOreCost, geodeRobotOreCost});
+        search::LevelSearch<State, unsigned int> states{State {0, 0, 0, { 0, 0, 1}}, 0U};
         for(auto minute = 1U; minute <= minutes; ++minute){
-            std::cout << minute << "\n";
-            decltype(states) newStates;
-            auto maxGeodes = 0U;
-            for(const auto& statePair: states){
-                auto& [state, geodes] = statePair;
-                // if we produce a new robot every minute from hear on out, will we eclipse our max geodes?
-                // if not, let's skip it
-                auto minutesLeft = minutes - minute;
-                if(geodes + (minutesLeft * (minutesLeft + 1))/2 < maxGeodes) {
-                    continue;
-                }
+            auto minutesLeft = minutes - minute;
+            auto expand = [this, minute, minutes, minutesLeft, maxOreCost](const State& state, unsigned int geodes, auto& emit){
                 State newState {
                     state.obsidianCollected + state.robots.obsidian,
                     state.clayCollected + state.robots.clay,
                     state.oreCollected + state.robots.ore,
                     state.robots
                 };
-                addToStatesMap(newStates, newState, geodes);
+                emit(newState, geodes);
                 //only produce ore if its not the last turn
-                if(minute != minutes && state.oreCollected >= oreRobotOreCost){
+                if(minute != minutes && state.oreCollected >= oreRobotOreCost && state.robots.ore < maxOreCost){
                     State oreState(newState);
                     oreState.oreCollected -= oreRobotOreCost;
                     oreState.robots.ore++;
-                    addToStatesMap(newStates, oreState, geodes);
+                    emit(oreState, geodes);
                 }
                 // don't produce clay on the last turn, becasue it won't matter for geodes
-                if(minute < minutes - 1 && state.oreCollected >= clayRobotOreCost){
+                if(minute < minutes - 1 && state.oreCollected >= clayRobotOreCost && state.robots.clay < obsidianRobotClayCost){
                     State clayState(newState);
                     clayState.oreCollected -= clayRobotOreCost;
                     clayState.robots.clay++;
-                    addToStatesMap(newStates, clayState, geodes);
+                    emit(clayState, geodes);
                 }
                 // don't build an obsidian bot on the second to last turn, becasue it won't help with geode
-                if(minute < minutes - 1 && state.oreCollected >= obsidianRobotOreCost && state.clayCollected >= obsidianRobotClayCost){
+                if(minute < minutes - 1 && state.oreCollected >= obsidianRobotOreCost && state.clayCollected >= obsidianRobotClayCost && state.robots.obsidian < geodeRobotObsidianCost){
                     State obsidianState(newState);
                     obsidianState.oreCollected -= obsidianRobotOreCost;
                     obsidianState.clayCollected -= obsidianRobotClayCost;
                     obsidianState.robots.obsidian++;
-                    addToStatesMap(newStates, obsidianState, geodes);
+                    emit(obsidianState, geodes);
                 }
                 // don't produce a geode bot on the last turn
                 if(minute != minutes && state.oreCollected >= geodeRobotOreCost && state.obsidianCollected >= geodeRobotObsidianCost){
                     State geodeState(newState);
                     geodeState.oreCollected -= geodeRobotOreCost;
                     geodeState.obsidianCollected -= geodeRobotObsidianCost;
-                    addToStatesMap(newStates, geodeState, geodes+minutesLeft);
-                    maxGeodes = std::max(maxGeodes, geodes + minutesLeft);
+                    emit(geodeState, geodes+minutesLeft);
                 }
-
-            }
-            std::swap(newStates, states);
+            };
+            // if we produce a new robot every minute from here on out, will we eclipse our max geodes?
+            // if not, let's skip it
+            auto bound = [minutesLeft](const State&, unsigned int geodes){
+                return geodes + (minutesLeft * (minutesLeft + 1))/2;
+            };
+            states.advance(expand, bound);
         }
-        return std::ranges::max(states | std::views::values);
+        return states.getBest();
     }
 };
 
 unsigned int getTotalBlueprintQuality(std::span<Blueprint> blueprints, unsigned int minutes) {
-    return std::accumulate(blueprints.begin(), blueprints.end(), 0U, [minutes](unsigned int sum, const Blueprint& blueprint){ 
-        std::cout << "Blueprint " << blueprint.id << "\n";
-        return sum + blueprint.id * blueprint.getGeodes(minutes);
-    });
+    return parallel::parallelReduce(0, blueprints.size(), 0U, [blueprints, minutes](size_t index){
+        return blueprints[index].id * blueprints[index].getGeodes(minutes);
+    }, std::plus<>(), 1);
 }
 
 unsigned int getTotalExtendedBlueprintQuality(std::span<Blueprint> blueprints, unsigned int minutes) {
-    return std::accumulate(blueprints.begin(), blueprints.end(), 1U, [minutes](unsigned int sum, const Blueprint& blueprint){ 
-        std::cout << "Blueprint " << blueprint.id << "\n";
-        return sum * blueprint.getGeodes(minutes);
-    });
+    return parallel::parallelReduce(0, blueprints.size(), 1U, [blueprints, minutes](size_t index){
+        return blueprints[index].getGeodes(minutes);
+    }, std::multiplies<>(), 1);
 }
 
 int main() {
@@ -1,10 +1,17 @@
+#include <array>
+#include <bit>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
-#include <istream>
-#include <numeric>
 #include <span>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "embed.h"
 #include "input.h"
 enum class Move {
     Rock,
@@ -18,28 +25,27 @@ enum class Outcome {
     Win
 };
 
-const std::unordered_map<char, Move> moveMapping = {
-    {'A', Move::Rock},
-    {'B', Move::Paper},
-    {'C', Move::Scissors},
-    {'X', Move::Rock},
-    {'Y', Move::Paper},
-    {'Z', Move::Scissors}
-};
-
-const std::unordered_map<Move, unsigned int> scoreMapping = {
-    {Move::Rock, 1U},
-    {Move::Paper, 2U},
-    {Move::Scissors, 3U}
-};
+constexpr unsigned int getMoveScore(Move move) {
+    switch(move) {
+        case Move::Rock: return 1U;
+        case Move::Paper: return 2U;
+        case Move::Scissors: return 3U;
+    }
+    assert(false);
+    return 0U;
+}
 
-const std::unordered_map<Outcome, unsigned int> outcomeMapping = {
-    {Outcome::Loss, 0U},
-    {Outcome::Draw, 3U},
-    {Outcome::Win, 6U}
-};
+constexpr unsigned int getOutcomeScore(Outcome outcome) {
+    switch(outcome) {
+        case Outcome::Loss: return 0U;
+        case Outcome::Draw: return 3U;
+        case Outcome::Win: return 6U;
+    }
+    assert(false);
+    return 0U;
+}
 
-Outcome getOutcome(Move opponentMove, Move yourMove) {
+constexpr Outcome getOutcome(Move opponentMove, Move yourMove) {
     if (yourMove == opponentMove) {
         return Outcome::Draw;
     }
@@ -52,7 +58,7 @@ Outcome getOutcome(Move opponentMove, Move yourMove) {
 
 }
 
-Move getYourMove(Move opponentMove, Outcome outcome) {
+constexpr Move getYourMove(Move opponentMove, Outcome outcome) {
     if (outcome == Outcome::Draw){
         return opponentMove;
     }
@@ -78,55 +84,114 @@ Move getYourMove(Move opponentMove, Outcome outcome) {
 
 }
 
-class Game {
-public:
+// how many times each "<opponent> <you>" line shows up, indexed by opponent * 3 + you
+using Histogram = std::array<uint64_t, 9>;
+
+// constexpr so an embedded input gets counted by the compiler
+constexpr Histogram countPairs(std::string_view text) {
+    Histogram histogram {};
+    size_t index = 0;
+    auto countAt = [&histogram, text](size_t position) {
+        auto opponent = text[position] - 'A';
+        auto you = text[position + 2] - 'X';
+        if(opponent >= 0 && opponent < 3 && you >= 0 && you < 3 && text[position + 1] == ' ') {
+            ++histogram[static_cast<size_t>(opponent * 3 + you)];
+        }
+    };
+#ifdef __SSE2__
+    if !consteval {
+        // compare a block against each opponent letter, the block one byte on against the space and the block
+        // two bytes on against each of your letters: the same "<opponent> <you>" check as the scalar loop,
+        // sixteen starting positions at a time and without looking for newlines
+        for(; index + 2 + sizeof(__m128i) <= text.size(); index += sizeof(__m128i)) {
+            auto opponents = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + index)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            auto separators = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + index + 1)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            auto yours = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + index + 2)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            auto isSpace = _mm_cmpeq_epi8(separators, _mm_set1_epi8(' '));
+            for(char opponent = 0; opponent < 3; ++opponent) {
+                auto opponentMatches = _mm_and_si128(isSpace, _mm_cmpeq_epi8(opponents, _mm_set1_epi8(static_cast<char>('A' + opponent))));
+                for(char you = 0; you < 3; ++you) {
+                    auto matches = _mm_and_si128(opponentMatches, _mm_cmpeq_epi8(yours, _mm_set1_epi8(static_cast<char>('X' + you))));
+                    histogram[static_cast<size_t>(opponent * 3 + you)] += static_cast<uint64_t>(std::popcount(static_cast<unsigned int>(_mm_movemask_epi8(matches))));
+                }
+            }
+        }
+    }
+#endif
+    for(; index + 2 < text.size(); ++index) {
+        countAt(index);
+    }
+    return histogram;
+}
+
+// a strategy: what each of the 9 lines is worth to you, indexed like the histogram
+using ScoreTable = std::array<unsigned int, 9>;
 
-    friend std::istream& operator>>(std::istream& stream, Game& game) {
-        stream >> game.opponentChar >> game.yourChar;
-        return stream;
+template <typename Score>
+constexpr ScoreTable makeScoreTable(Score score) {
+    ScoreTable table {};
+    for(size_t opponent = 0; opponent < 3; ++opponent) {
+        for(size_t you = 0; you < 3; ++you) {
+            table[opponent * 3 + you] = score(static_cast<Move>(opponent), you);
+        }
     }
+    return table;
+}
 
-    unsigned int getScore() const {
+// X, Y and Z are the moves to play
+constexpr ScoreTable makeMoveStrategy(const std::array<Move, 3>& moves) {
+    return makeScoreTable([&moves](Move opponentMove, size_t you) {
+        return getMoveScore(moves[you]) + getOutcomeScore(getOutcome(opponentMove, moves[you]));
+    });
+}
 
-        const Move opponentMove = moveMapping.at(opponentChar);
-        const Move yourMove = moveMapping.at(yourChar);
+// X, Y and Z are how the round has to end
+constexpr ScoreTable makeOutcomeStrategy(const std::array<Outcome, 3>& outcomes) {
+    return makeScoreTable([&outcomes](Move opponentMove, size_t you) {
+        return getMoveScore(getYourMove(opponentMove, outcomes[you])) + getOutcomeScore(outcomes[you]);
+    });
+}
 
-        return scoreMapping.at(yourMove) + outcomeMapping.at(getOutcome(opponentMove, yourMove));
-    }
+constexpr ScoreTable scoreTable = makeMoveStrategy({Move::Rock, Move::Paper, Move::Scissors});
+constexpr ScoreTable revisedScoreTable = makeOutcomeStrategy({Outcome::Loss, Outcome::Draw, Outcome::Win});
 
-    unsigned int getRevisedScore() const {
-        std::unordered_map<char, Outcome> outcomeStringMapping = {
-            {'X', Outcome::Loss},
-            {'Y', Outcome::Draw},
-            {'Z', Outcome::Win}
-        };
-        const Move opponentMove = moveMapping.at(opponentChar);
-        const Outcome outcome = outcomeStringMapping.at(yourChar);
-        const Move yourMove = getYourMove(opponentMove, outcome);
-
-        return scoreMapping.at(yourMove) + outcomeMapping.at(outcome);
+// totals[i] += what strategies[i] scores over the whole histogram
+// one walk over the bins however many strategies there are, empty bins skip every strategy at once
+constexpr void addTotalScores(const Histogram& histogram, std::span<const ScoreTable> strategies, std::span<uint64_t> totals) {
+    assert(strategies.size() == totals.size());
+    for(size_t pair = 0; pair < histogram.size(); ++pair) {
+        if(histogram[pair] == 0) {
+            continue;
+        }
+        for(size_t strategy = 0; strategy < strategies.size(); ++strategy) {
+            totals[strategy] += histogram[pair] * strategies[strategy][pair];
+        }
     }
+}
 
-private:
-    char opponentChar = 'A';
-    char yourChar = 'X';
-};
-
-unsigned int getTotalScore(std::span<Game> games) {
-    return std::accumulate(games.begin(), games.end(), 0U, [](unsigned int sum, const Game& game){
-        return sum + game.getScore();
-    });
+template <size_t N>
+constexpr std::array<uint64_t, N> getTotalScores(const Histogram& histogram, const std::array<ScoreTable, N>& strategies) {
+    std::array<uint64_t, N> totals {};
+    addTotalScores(histogram, strategies, totals);
+    return totals;
 }
 
-unsigned int getRevisedTotalScore(std::span<Game> games) {
-    return std::accumulate(games.begin(), games.end(), 0U, [](unsigned int sum, const Game& game){
-        return sum + game.getRevisedScore();
-    });
+std::vector<uint64_t> getTotalScores(const Histogram& histogram, std::span<const ScoreTable> strategies) {
+    std::vector<uint64_t> totals(strategies.size(), 0);
+    addTotalScores(histogram, strategies, totals);
+    return totals;
 }
 
+constexpr std::array strategies {scoreTable, revisedScoreTable};
+
 int main() {
-    auto games = input::readLines<Game>("input/input2.txt");
-    std::cout << "Total score is " << getTotalScore(games) << "\n";
-    std::cout << "Total revised score is " << getRevisedTotalScore(games) << "\n";
+#ifdef EMBED_INPUT_FILE
+    // all worked out by the compiler
+    constexpr auto totals = getTotalScores(countPairs(input::embedded), strategies);
+#else
+    const auto totals = getTotalScores(countPairs(input::readFile("input/input2.txt").value_or("")), strategies);
+#endif
+    std::cout << "Total score is " << totals[0] << "\n";
+    std::cout << "Total revised score is " << totals[1] << "\n";
     return 0;
-}
\ No newline at end of file
+}
@@ -8,6 +8,7 @@
 
 #include "input.h"
 #include "grid.h"
+#include "perfcounters.h"
 
 struct Instruction { 
     size_t steps;
@@ -378,15 +379,18 @@ unsigned int toScore(Grid::Direction direction){
 }
 
 int main() {
-    std::ifstream in("input/input22.txt");
     Grid::Grid<char> grid(std::identity{});
     std::vector<Instruction> instructions;
-    in >> grid >> instructions;
-    auto [coord, direction] = getFinalPosition(grid, instructions); 
+    {
+        const perf::Phase phase("parse");
+        std::ifstream in("input/input22.txt");
+        in >> grid >> instructions;
+    }
+    auto [coord, direction] = perf::measure("flat map", [&grid, &instructions](){ return getFinalPosition(grid, instructions); });
     std::cout << "Password: " << ((coord.yPos+1) * 1000 + (coord.xPos+1) * 4 + toScore(direction)) << "\n";
 
 
-    auto [cubeCoord, cubeDirection] = getCubeFinalPosition(grid, instructions); 
+    auto [cubeCoord, cubeDirection] = perf::measure("cube", [&grid, &instructions](){ return getCubeFinalPosition(grid, instructions); });
     std::cout << "Password: " << ((cubeCoord.yPos+1) * 1000 + (cubeCoord.xPos+1) * 4 + toScore(cubeDirection)) << "\n";
     
     return 0;
@@ -4,9 +4,11 @@
 #include <functional>
 #include <iostream>
 #include <map>
+#include <memory_resource>
 #include <span>
 #include <vector>
 
+#include "arena.h"
 #include "grid.h"
 #include "input.h"
 
@@ -78,15 +80,17 @@ std::vector<Elf> toElves(const Grid::Grid<char>& grid) {
     return elves;
 }
 
-bool runRound(std::span<Elf> elves) {
-    std::map<Grid::Coord, unsigned int> proposedMoves;
+// everything allocated in a round lives in roundArena, which gets rewound at the start of the next one
+bool runRound(std::span<Elf> elves, arena::Arena& roundArena) {
+    roundArena.reset();
+    std::pmr::map<Grid::Coord, unsigned int> proposedMoves{&roundArena};
     for(const auto& elf: elves){
         auto move = elf.getProposedMove(elves);
         proposedMoves.try_emplace(move, 0U);
         proposedMoves[move]++;
     }
 
-    std::vector<Elf> oldElves(elves.begin(), elves.end());
+    std::pmr::vector<Elf> oldElves(elves.begin(), elves.end(), &roundArena);
     for(auto& elf: elves) {
         auto move = elf.getProposedMove(oldElves);
         if(proposedMoves.at(move) == 1){
@@ -96,7 +100,7 @@ bool runRound(std::span<Elf> elves) {
         }
     }
     std::rotate(offsetDirectionPairs.begin(), offsetDirectionPairs.begin() + 1, offsetDirectionPairs.end());
-    std::vector<Elf> newElves(elves.begin(), elves.end());
+    std::pmr::vector<Elf> newElves(elves.begin(), elves.end(), &roundArena);
     return oldElves != newElves;
 }
 
@@ -117,8 +121,9 @@ size_t getEmptySpaces(std::span<Elf> elves) {
 
 size_t getEmptySpacesAfter(const Grid::Grid<char>& grid, unsigned int rounds) {
     auto elves = toElves(grid);
+    arena::Arena roundArena;
     for(unsigned int round = 0; round < rounds; ++round){
-        runRound(elves);
+        runRound(elves, roundArena);
     }
     return getEmptySpaces(elves);
 }
@@ -126,8 +131,9 @@ size_t getEmptySpacesAfter(const Grid::Grid<char>& grid, unsigned int rounds) {
 size_t getEmptySpacesWhenStatic(const Grid::Grid<char>& grid) {
     size_t round = 0;
     auto elves = toElves(grid);
+    arena::Arena roundArena;
     while(true) {
-        bool atLeastOneMoveMade = runRound(elves);
+        bool atLeastOneMoveMade = runRound(elves, roundArena);
         ++round;
         if (!atLeastOneMoveMade) {
             return round;
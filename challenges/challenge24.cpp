@@ -1,9 +1,12 @@
 #include <algorithm>
+#include <array>
 #include <fstream>
 #include <iostream>
+#include <memory_resource>
 #include <set>
 #include <vector>
 
+#include "arena.h"
 #include "grid.h"
 #include "input.h"
 
@@ -47,12 +50,20 @@ char getOppositeBlizzard(Grid::Direction direction){
 
 
 unsigned int getMinutesUntilPathCompleted(const Grid::Grid<char>& grid, Grid::Coord startingPosition, Grid::Coord endingPosition, size_t startingTicks){
-    std::set<Grid::Coord> possibilities {startingPosition};
+    // ping-pong between two frontiers, each with its own arena, so building the next
+    // tick only ever rewinds memory that the previous tick is done with
+    std::array<arena::Arena, 2> arenas;
+    std::array<std::pmr::set<Grid::Coord>, 2> frontiers {std::pmr::set<Grid::Coord>{&arenas[0]}, std::pmr::set<Grid::Coord>{&arenas[1]}};
+    frontiers[0].insert(startingPosition);
+    size_t current = 0;
     auto ticks = startingTicks;
     auto maxY = grid.getMaxY();
     auto maxX = grid.getMaxX();
-    while(!possibilities.empty()){
-        std::set<Grid::Coord> newPossibilities;
+    while(!frontiers[current].empty()){
+        const auto& possibilities = frontiers[current];
+        auto& newPossibilities = frontiers[1 - current];
+        newPossibilities.clear();
+        arenas[1 - current].reset();
         for(const auto& coord: possibilities) {
             if(coord == endingPosition) {
                 return ticks;
@@ -76,7 +87,7 @@ unsigned int getMinutesUntilPathCompleted(const Grid::Grid<char>& grid, Grid::Co
                 }
             }
         }
-        std::swap(possibilities, newPossibilities);
+        current = 1 - current;
         ++ticks;
     }
     assert(false); // should not reeach here
@@ -4,16 +4,19 @@
 #include <istream>
 #include <numeric>
 #include <ranges>
+#include <string>
+#include <string_view>
 
+#include "embed.h"
 #include "input.h"
 
 
-std::string toSnafuNumber(int64_t number) {
+constexpr std::string toSnafuNumber(int64_t number) {
     std::string out = "";
     while(number != 0) {
         auto remainder = number % 5;
         if(remainder < 3){
-            out += std::to_string(remainder);
+            out += static_cast<char>('0' + remainder);
             number -= remainder;
         }
         else if(remainder == 3) {
@@ -29,7 +32,7 @@ std::string toSnafuNumber(int64_t number) {
     return std::string(out.rbegin(), out.rend());
 }
 
-int64_t fromSnafuNumber(const std::string& str) {
+constexpr int64_t fromSnafuNumber(std::string_view str) {
     int64_t sum = 0U;
     int64_t factor = 1;
     for(char c: std::views::reverse(str)) {
@@ -47,8 +50,17 @@ int64_t fromSnafuNumber(const std::string& str) {
     return sum;
 }
 
+constexpr int64_t getSnafuTotal(std::string_view text) {
+    auto numbers = input::splitLines(text) | std::views::transform(fromSnafuNumber);
+    return std::accumulate(numbers.begin(), numbers.end(), 0LL);
+}
+
 int main() {
-    auto numbers = input::readLines("input/input25.txt") | std::views::transform(fromSnafuNumber);
+#ifdef EMBED_INPUT_FILE
+    constexpr int64_t total = getSnafuTotal(input::embedded);
+#else
+    auto numbers = input::readLines("input/input25.txt") | std::views::transform([](const std::string& str){ return fromSnafuNumber(str); });
     int64_t total = std::accumulate(numbers.begin(), numbers.end(), 0LL);
+#endif
     std::cout <<  fromSnafuNumber("1=10-0001=--==2") << " " << total << " " << toSnafuNumber(total) << "\n";
 }
@@ -1,73 +1,103 @@
-#include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
-#include <istream>
-#include <numeric>
-#include <set>
-#include <span>
-#include <string>
+#include <string_view>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "input.h"
 
-unsigned int getPriority(char item) {
-    // getting priority a-z = 1-26 or A-Z = 27 - 52
-    return islower(item) != 0 ? item - 96 : item - 64 + 26;
-}
+// Every bag or compartment is a 52 bit mask with bit (priority - 1) set for each item in it,
+// so items in common are an AND and the priority of the one shared item is countr_zero + 1
+using ItemMask = uint64_t;
 
-class Group {
-public:
-    friend std::istream& operator>>(std::istream& stream, Group& group){
-        stream >> group.bag1 >> group.bag2 >> group.bag3;
-        // sort so we can do set operations on them
-        std::ranges::sort(group.bag1);
-        std::ranges::sort(group.bag2);
-        std::ranges::sort(group.bag3);
-        return stream;
+// anything that isn't a letter (a stray '\r', say) isn't an item and is left out
+ItemMask getItemMask(std::string_view items) {
+    constexpr uint8_t notAnItem = 0xFF;
+    ItemMask mask = 0;
+    size_t index = 0;
+#ifdef __SSE2__
+    // work out sixteen bit positions at once: a-z = 0-25, A-Z = 26-51, everything else notAnItem
+    auto isBetween = [](__m128i block, char low, char high) {
+        return _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(static_cast<char>(low - 1))), _mm_cmplt_epi8(block, _mm_set1_epi8(static_cast<char>(high + 1))));
+    };
+    for(; index + sizeof(__m128i) <= items.size(); index += sizeof(__m128i)) {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(items.data() + index)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto isLower = isBetween(block, 'a', 'z');
+        auto isLetter = _mm_or_si128(isLower, isBetween(block, 'A', 'Z'));
+        auto base = _mm_or_si128(_mm_and_si128(isLower, _mm_set1_epi8('a')), _mm_andnot_si128(isLower, _mm_set1_epi8('A' - 26)));
+        auto positions = _mm_or_si128(_mm_and_si128(isLetter, _mm_sub_epi8(block, base)), _mm_andnot_si128(isLetter, _mm_set1_epi8(static_cast<char>(notAnItem))));
+        alignas(16) std::array<uint8_t, sizeof(__m128i)> bits {};
+        _mm_store_si128(reinterpret_cast<__m128i*>(bits.data()), positions); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        for(auto bit: bits) {
+            if(bit != notAnItem) {
+                mask |= ItemMask{1} << bit;
+            }
+        }
     }
-
-    unsigned int getPriority() const {
-        std::set<char> firstMatch;
-        std::ranges::set_intersection(bag1, bag2, std::inserter(firstMatch, firstMatch.begin()));
-        assert(!firstMatch.empty());
-
-        std::set<char> commonLetter;
-        std::ranges::set_intersection(firstMatch, bag3, std::inserter(commonLetter, commonLetter.begin()));
-        assert(commonLetter.size() == 1);
-
-        return ::getPriority(*commonLetter.begin());
+#endif
+    for(auto item: items.substr(index)) {
+        if(item >= 'a' && item <= 'z') {
+            mask |= ItemMask{1} << (item - 'a');
+        }
+        else if(item >= 'A' && item <= 'Z') {
+            mask |= ItemMask{1} << (item - 'A' + 26);
+        }
     }
-
-
-private:
-    std::string bag1, bag2, bag3;
-};
-
-unsigned int getRucksackPriority(const std::string& text) {
-    assert(text.length() <= INT32_MAX);
-    const auto midpoint = static_cast<int32_t>(text.length() / 2);
-    auto match = std::find_first_of(text.begin(), text.begin()+midpoint, text.begin()+midpoint, text.end());
-    assert(match != text.end());
-    return getPriority(*match);
+    return mask;
 }
 
-unsigned int getTotalPriority(std::span<std::string> rucksacks) {
-    return std::accumulate(rucksacks.begin(), rucksacks.end(), 0U, [](unsigned int sum, const std::string& text){
-        return sum + getRucksackPriority(text);
-    });
+unsigned int getPriority(ItemMask common) {
+    assert(std::popcount(common) == 1);
+    return static_cast<unsigned int>(std::countr_zero(common)) + 1;
 }
 
-unsigned int getTotalGroupPriority(std::span<Group> groups) {
-    return std::accumulate(groups.begin(), groups.end(), 0U, [](unsigned int sum, const Group& group){
-        return sum + group.getPriority();
-    });
+unsigned int getRucksackPriority(std::string_view text) {
+    const auto midpoint = text.length() / 2;
+    return getPriority(getItemMask(text.substr(0, midpoint)) & getItemMask(text.substr(midpoint)));
 }
 
+struct Priorities {
+    unsigned int rucksacks = 0U;
+    unsigned int groups = 0U;
+};
+
+// one walk over the lines feeds both answers: every rucksack on its own,
+// and a running AND that closes off a group every third line
+Priorities getPriorities(std::string_view text) {
+    Priorities priorities;
+    ItemMask groupCommon = ~ItemMask{0};
+    size_t bagsInGroup = 0;
+    while(!text.empty()) {
+        auto end = text.find('\n');
+        auto line = text.substr(0, end);
+        text = (end == std::string_view::npos) ? std::string_view{} : text.substr(end + 1);
+        if(!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if(line.empty()) {
+            continue;
+        }
 
-int main(){ 
-    auto rucksacks = input::readLines("input/input3.txt");
-    std::cout << "Total priority is: " << getTotalPriority(rucksacks) << "\n";
+        priorities.rucksacks += getRucksackPriority(line);
+        groupCommon &= getItemMask(line);
+        if(++bagsInGroup == 3) {
+            priorities.groups += getPriority(groupCommon);
+            groupCommon = ~ItemMask{0};
+            bagsInGroup = 0;
+        }
+    }
+    assert(bagsInGroup == 0);
+    return priorities;
+}
 
-    auto groups = input::readLines<Group>("input/input3.txt");
-    std::cout << "Total group priority is: " << getTotalGroupPriority(groups) << "\n";
 
-}
\ No newline at end of file
+int main(){ 
+    auto priorities = getPriorities(input::readFile("input/input3.txt").value_or(""));
+    std::cout << "Total priority is: " << priorities.rucksacks << "\n";
+    std::cout << "Total group priority is: " << priorities.groups << "\n";
+}
@@ -1,57 +1,252 @@
 #include <algorithm>
-#include <cassert>
+#include <array>
+#include <cstdint>
 #include <iostream>
-#include <istream>
-#include <regex>
-#include <span>
+#include <random>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
+#include "differential.h"
 #include "input.h"
+#include "intervals.h"
 
-using Range = std::pair<unsigned int, unsigned int>;
+using Range = std::pair<uint32_t, uint32_t>;
+using AssignmentIndex = intervals::StaticIntervalIndex<uint32_t>;
 
-class RangePair {
-public:
-    friend std::istream& operator>>(std::istream& stream, RangePair& rangePair){
-        std::string text;
-        stream >> text;
+// Struct of arrays, one column per number on the line, so classifying is a straight
+// run over four flat arrays that the compiler turns into vector compares
+struct RangePairs {
+    std::vector<uint32_t> firstStarts;
+    std::vector<uint32_t> firstEnds;
+    std::vector<uint32_t> secondStarts;
+    std::vector<uint32_t> secondEnds;
 
-        const std::regex rangePairRegex { "(\\d+)-(\\d+),(\\d+)-(\\d+)"};
-        std::smatch match;
-        auto result = std::regex_search(text, match, rangePairRegex);
-        assert(result);
+    size_t size() const {
+        return firstStarts.size();
+    }
+};
 
-        rangePair.elf1 = Range{std::stoi(match[1]), std::stoi(match[2])};
-        rangePair.elf2 = Range{std::stoi(match[3]), std::stoi(match[4])};
+// every line is "a-b,c-d", anything that isn't a digit separates numbers
+RangePairs parseRangePairs(std::string_view text) {
+    RangePairs pairs;
+    const auto expectedLines = text.size() / 8;
+    for(auto* column: {&pairs.firstStarts, &pairs.firstEnds, &pairs.secondStarts, &pairs.secondEnds}){
+        column->reserve(expectedLines);
+    }
 
-        return stream;
+    std::array<uint32_t, 4> numbers {};
+    size_t numberIndex = 0;
+    uint32_t current = 0;
+    bool inNumber = false;
+    auto finishLine = [&](){
+        if(numberIndex == numbers.size()){
+            pairs.firstStarts.push_back(numbers[0]);
+            pairs.firstEnds.push_back(numbers[1]);
+            pairs.secondStarts.push_back(numbers[2]);
+            pairs.secondEnds.push_back(numbers[3]);
+        }
+        numberIndex = 0;
+    };
+    for(auto c: text){
+        if(c >= '0' && c <= '9'){
+            current = current * 10 + static_cast<uint32_t>(c - '0');
+            inNumber = true;
+            continue;
+        }
+        if(inNumber && numberIndex < numbers.size()){
+            numbers[numberIndex++] = current;
+        }
+        current = 0;
+        inNumber = false;
+        if(c == '\n'){
+            finishLine();
+        }
+    }
+    if(inNumber && numberIndex < numbers.size()){
+        numbers[numberIndex++] = current;
     }
+    finishLine();
+    return pairs;
+}
 
-    bool doesOnePairContainOther() const { 
-        auto [firstElf,secondElf] = ((elf1.first < elf2.first) || (elf1.first == elf2.first && elf1.second > elf2.second)) ? std::pair{elf1, elf2} : std::pair{elf2, elf1};
-        return secondElf.first >= firstElf.first && secondElf.second <= firstElf.second;
+struct Counts {
+    uint32_t fullyContained = 0;
+    uint32_t overlapping = 0;
+
+    friend bool operator==(const Counts&, const Counts&) = default;
+};
+
+// both counts in one pass, no branches and no sorting the pair first
+Counts classify(const RangePairs& pairs) {
+    const auto* firstStarts = pairs.firstStarts.data();
+    const auto* firstEnds = pairs.firstEnds.data();
+    const auto* secondStarts = pairs.secondStarts.data();
+    const auto* secondEnds = pairs.secondEnds.data();
+    uint32_t fullyContained = 0;
+    uint32_t overlapping = 0;
+    for(size_t index = 0; index < pairs.size(); ++index){
+        // NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const uint32_t firstHoldsSecond = static_cast<uint32_t>(firstStarts[index] <= secondStarts[index]) & static_cast<uint32_t>(secondEnds[index] <= firstEnds[index]);
+        const uint32_t secondHoldsFirst = static_cast<uint32_t>(secondStarts[index] <= firstStarts[index]) & static_cast<uint32_t>(firstEnds[index] <= secondEnds[index]);
+        const uint32_t overlaps = static_cast<uint32_t>(firstStarts[index] <= secondEnds[index]) & static_cast<uint32_t>(secondStarts[index] <= firstEnds[index]);
+        // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        fullyContained += firstHoldsSecond | secondHoldsFirst;
+        overlapping += overlaps;
     }
+    return {fullyContained, overlapping};
+}
 
-    bool doesOverlap() const { 
-        auto [firstElf,secondElf] = ((elf1.first < elf2.first) || (elf1.first == elf2.first && elf1.second > elf2.second)) ? std::pair{elf1, elf2} : std::pair{elf2, elf1};
-        return firstElf.second >= secondElf.first;
+// every assignment as its own interval, pair p's elves get ids 2p and 2p + 1
+AssignmentIndex buildAssignmentIndex(const RangePairs& pairs) {
+    std::vector<Range> assignments;
+    assignments.reserve(pairs.size() * 2);
+    for(size_t index = 0; index < pairs.size(); ++index){
+        assignments.emplace_back(pairs.firstStarts[index], pairs.firstEnds[index]);
+        assignments.emplace_back(pairs.secondStarts[index], pairs.secondEnds[index]);
     }
-private:
-    Range elf1, elf2;
-};
+    return AssignmentIndex(assignments);
+}
 
-unsigned int getFullyContainedPairs(std::span<RangePair> rangePairs){
-    return std::ranges::count_if(rangePairs, [](const RangePair& pair){ return pair.doesOnePairContainOther(); }); 
+// how many elves have this section on their list
+size_t countElvesCovering(const AssignmentIndex& assignments, uint32_t section) {
+    return assignments.countContaining(section);
 }
 
-unsigned int getOverlappingPairs(std::span<RangePair> rangePairs){
-    return std::ranges::count_if(rangePairs, [](const RangePair& pair){ return pair.doesOverlap(); }); 
+// pairs with either elf assigned somewhere in [start, end], in order
+std::vector<size_t> findPairsOverlapping(const AssignmentIndex& assignments, uint32_t start, uint32_t end) {
+    std::vector<size_t> pairs;
+    assignments.forEachOverlapping(start, end, [&pairs](size_t id, uint32_t, uint32_t){ pairs.push_back(id / 2); });
+    std::ranges::sort(pairs);
+    auto duplicates = std::ranges::unique(pairs);
+    pairs.erase(duplicates.begin(), duplicates.end());
+    return pairs;
 }
 
+// sections at least one elf has to clean
+uint32_t countSectionsCovered(const AssignmentIndex& assignments) {
+    return assignments.getCoveredLength();
+}
+
+// the same two counts asked of the index instead: one range stabbing query per pair
+// with the first elf's range, and see if the second elf turns up in it
+Counts classifyWithIndex(const RangePairs& pairs, const AssignmentIndex& assignments) {
+    Counts counts;
+    for(size_t index = 0; index < pairs.size(); ++index){
+        const auto start = pairs.firstStarts[index];
+        const auto end = pairs.firstEnds[index];
+        assignments.forEachOverlapping(start, end, [&counts, start, end, partner = index * 2 + 1](size_t id, uint32_t otherStart, uint32_t otherEnd){
+            if(id != partner){
+                return;
+            }
+            ++counts.overlapping;
+            if((start <= otherStart && otherEnd <= end) || (otherStart <= start && end <= otherEnd)){
+                ++counts.fullyContained;
+            }
+        });
+    }
+    return counts;
+}
+
+
+#ifdef DIFFERENTIAL
+// everything the index can answer about a set of assignments, next to the plain counts
+struct Survey {
+    Counts counts;
+    Counts countsFromIndex;
+    std::vector<size_t> elvesCovering;
+    std::vector<std::vector<size_t>> pairsOverlapping;
+    uint32_t sectionsCovered = 0;
 
+    friend bool operator==(const Survey&, const Survey&) = default;
+};
+
+int main() {
+    struct Case {
+        std::string text;
+        std::vector<Range> queries;
+    };
+    auto generate = [](auto& rng, size_t size){
+        std::uniform_int_distribution<uint32_t> section(1, std::max<uint32_t>(99, static_cast<uint32_t>(size)));
+        auto range = [&](){
+            auto one = section(rng);
+            auto other = section(rng);
+            return Range{std::min(one, other), std::max(one, other)};
+        };
+        Case generated;
+        for(size_t index = 0; index < size; ++index){
+            auto [firstStart, firstEnd] = range();
+            auto [secondStart, secondEnd] = range();
+            generated.text += std::to_string(firstStart) + "-" + std::to_string(firstEnd) + "," + std::to_string(secondStart) + "-" + std::to_string(secondEnd) + "\n";
+        }
+        for(size_t index = 0; index < 64; ++index){
+            generated.queries.push_back(range());
+        }
+        return generated;
+    };
+    // one pair at a time, and every query by looking at every elf
+    auto reference = [](const Case& input){
+        auto pairs = parseRangePairs(input.text);
+        std::vector<std::array<Range, 2>> elves;
+        Survey survey;
+        for(size_t index = 0; index < pairs.size(); ++index){
+            Range first {pairs.firstStarts[index], pairs.firstEnds[index]};
+            Range second {pairs.secondStarts[index], pairs.secondEnds[index]};
+            elves.push_back({first, second});
+            if((first.first <= second.first && second.second <= first.second) || (second.first <= first.first && first.second <= second.second)){
+                ++survey.counts.fullyContained;
+            }
+            if(first.first <= second.second && second.first <= first.second){
+                ++survey.counts.overlapping;
+            }
+        }
+        survey.countsFromIndex = survey.counts;
+        for(auto [start, end]: input.queries){
+            size_t covering = 0;
+            std::vector<size_t> overlapping;
+            for(size_t index = 0; index < elves.size(); ++index){
+                bool anyOverlap = false;
+                for(auto [elfStart, elfEnd]: elves[index]){
+                    covering += (elfStart <= start && start <= elfEnd) ? 1 : 0;
+                    anyOverlap = anyOverlap || (elfStart <= end && start <= elfEnd);
+                }
+                if(anyOverlap){
+                    overlapping.push_back(index);
+                }
+            }
+            survey.elvesCovering.push_back(covering);
+            survey.pairsOverlapping.push_back(overlapping);
+        }
+        std::vector<bool> covered;
+        for(const auto& pair: elves){
+            for(auto [elfStart, elfEnd]: pair){
+                covered.resize(std::max<size_t>(covered.size(), elfEnd + 1));
+                std::fill(covered.begin() + elfStart, covered.begin() + elfEnd + 1, true);
+            }
+        }
+        survey.sectionsCovered = static_cast<uint32_t>(std::ranges::count(covered, true));
+        return survey;
+    };
+    auto candidate = [](const Case& input){
+        auto pairs = parseRangePairs(input.text);
+        auto assignments = buildAssignmentIndex(pairs);
+        Survey survey {classify(pairs), classifyWithIndex(pairs, assignments), {}, {}, countSectionsCovered(assignments)};
+        for(auto [start, end]: input.queries){
+            survey.elvesCovering.push_back(countElvesCovering(assignments, start));
+            survey.pairsOverlapping.push_back(findPairsOverlapping(assignments, start, end));
+        }
+        return survey;
+    };
+    auto options = differential::getOptions({100, 1'000, 10'000});
+    return differential::run("challenge4", options, generate, reference, candidate) ? 0 : 1;
+}
+#else
 int main(){
-    auto rangePairs = input::readLines<RangePair>("input/input4.txt");
-    std::cout << "Fully contained pairs: " << getFullyContainedPairs(rangePairs) << "\n";
-    std::cout << "Overlapping pairs: " << getOverlappingPairs(rangePairs) << "\n";
+    auto rangePairs = parseRangePairs(input::readFile("input/input4.txt").value_or(""));
+    auto counts = classify(rangePairs);
+    std::cout << "Fully contained pairs: " << counts.fullyContained << "\n";
+    std::cout << "Overlapping pairs: " << counts.overlapping << "\n";
     return 0;
-}
\ No newline at end of file
+}
+#endif
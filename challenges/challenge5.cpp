@@ -2,14 +2,22 @@
 #include <cassert>
 #include <iostream>
 #include <iterator>
+#include <random>
+#include <ranges>
 #include <regex>
 #include <span>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <utility>
 #include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "differential.h"
 #include "input.h"
+#include "rope.h"
 
 struct Move {
     uint64_t amount = 0;
@@ -35,27 +43,61 @@ Move toMove(const std::string& text) {
 using Stack = std::vector<char>;
 using Stacks = std::vector<Stack>;
 
+// stack i's crates are always at column 4i + 1, however wide its label is
+constexpr size_t getCrateColumn(size_t stack) {
+    return stack * 4 + 1;
+}
+
+// pull the letter out of every crate slot on a row, which is every fourth byte
+void extractCrates(std::string_view row, std::span<char> crates) {
+    size_t stack = 0;
+#ifdef __SSE2__
+    // 64 bytes in, 16 crates out: bring byte 1 of every 32 bit lane down to byte 0, mask, and pack twice
+    const auto lowByte = _mm_set1_epi32(0xFF);
+    auto load = [&row, lowByte](size_t offset) {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.data() + offset)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        return _mm_and_si128(_mm_srli_epi32(block, 8), lowByte);
+    };
+    for(; stack + 16 <= crates.size() && getCrateColumn(stack) - 1 + 64 <= row.size(); stack += 16) {
+        auto offset = getCrateColumn(stack) - 1;
+        auto firstHalf = _mm_packs_epi32(load(offset), load(offset + 16));
+        auto secondHalf = _mm_packs_epi32(load(offset + 32), load(offset + 48));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(crates.data() + stack), _mm_packus_epi16(firstHalf, secondHalf)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+#endif
+    for(; stack < crates.size(); ++stack) {
+        crates[stack] = getCrateColumn(stack) < row.size() ? row[getCrateColumn(stack)] : ' ';
+    }
+}
+
+// lines[0] is the label row, the rest go from the bottom row of crates up
 Stacks createStacks(std::span<std::string> lines) {
-    Stacks stacks {{}}; // empty spot in zero since stacks start at 1
-
-    std::unordered_map<std::string::size_type, size_t> textIndexToStackMapping;
-    auto numbers = *lines.begin();
-    auto position = numbers.find_first_of("123456789");
-    while(position != std::string::npos){
-        // only supports up to 9 stacks
-        textIndexToStackMapping[position] = stacks.size();
-        stacks.emplace_back();
-        position = (position >= numbers.length() - 1) ? std::string::npos : position + 1;
-        position = numbers.find_first_of("1234567789", position);
-    }
-
-    std::for_each(lines.begin()+1, lines.end(), [&stacks, &textIndexToStackMapping](const auto& line){
-        for(auto [textIndex, stack]: textIndexToStackMapping) {
-            if(line[textIndex] != ' '){ 
-                stacks[stack].push_back(line[textIndex]);
-            }
+    // labels can be any number of digits, so count them rather than reading them
+    // (and trust the widest row too, in case long labels run into each other)
+    size_t numberOfStacks = 0;
+    std::string_view labels = lines.front();
+    for(size_t position = labels.find_first_not_of(' '); position != std::string_view::npos; position = labels.find_first_not_of(' ', labels.find(' ', position))) {
+        ++numberOfStacks;
+    }
+    for(const auto& line: lines.subspan(1)) {
+        numberOfStacks = std::max(numberOfStacks, (line.size() + 1) / 4);
+    }
+
+    // every row's crates side by side in one block, rows bottom up
+    const size_t numberOfRows = lines.size() - 1;
+    std::vector<char> crates(numberOfRows * numberOfStacks);
+    for(size_t row = 0; row < numberOfRows; ++row) {
+        extractCrates(lines[row + 1], std::span(crates).subspan(row * numberOfStacks, numberOfStacks));
+    }
+
+    Stacks stacks(numberOfStacks + 1); // empty spot in zero since stacks start at 1
+    for(size_t stack = 0; stack < numberOfStacks; ++stack) {
+        auto& out = stacks[stack + 1];
+        out.reserve(numberOfRows);
+        for(size_t row = 0; row < numberOfRows && crates[row * numberOfStacks + stack] != ' '; ++row) {
+            out.push_back(crates[row * numberOfStacks + stack]);
         }
-    });
+    }
     return stacks;
 }
 
@@ -75,43 +117,228 @@ std::pair<Stacks, Moves> parseInput(std::span<std::string> lines){
     return {stacks, moves};
 }
 
-Stacks applyMoves(const Moves& moves, Stacks stacks) {
+// Every stack is a rope, so a move is one split and one merge whatever the amount.
+// Moving crates one at a time flips them over, which is just a reversed splice
+template <bool KeepOrder, typename Crate>
+std::vector<std::vector<Crate>> replayMoves(const Moves& moves, const std::vector<std::vector<Crate>>& stacks) {
+    rope::Forest<Crate> forest;
+    std::vector<typename rope::Forest<Crate>::Handle> ropes;
+    ropes.reserve(stacks.size());
+    for(const auto& stack: stacks){
+        ropes.push_back(forest.create(stack));
+    }
+
     for(const auto& move: moves){
-        for(unsigned int counter = 0; counter < move.amount; ++counter){
-            stacks[move.to].push_back(stacks[move.from].back());
-            stacks[move.from].pop_back();
+        auto fromSize = forest.size(ropes[move.from]);
+        assert(move.amount <= fromSize);
+        auto [staying, moving] = forest.split(ropes[move.from], fromSize - move.amount);
+        if constexpr (!KeepOrder) {
+            forest.reverse(moving);
         }
+        ropes[move.from] = staying;
+        ropes[move.to] = forest.merge(ropes[move.to], moving);
     }
-    return stacks;
+
+    std::vector<std::vector<Crate>> out;
+    out.reserve(ropes.size());
+    for(auto handle: ropes){
+        out.push_back(forest.toVector(handle));
+    }
+    return out;
+}
+
+Stacks applyMoves(const Moves& moves, const Stacks& stacks) {
+    return replayMoves<false>(moves, stacks);
 }
 
-Stacks apply9001StyleMoves(const Moves& moves, Stacks stacks) {
+Stacks apply9001StyleMoves(const Moves& moves, const Stacks& stacks) {
+    return replayMoves<true>(moves, stacks);
+}
+
+// where a crate sits: which stack, and how many crates are on top of it
+struct Position {
+    size_t stack = 0;
+    uint64_t depth = 0;
+
+    friend bool operator==(const Position&, const Position&) = default;
+};
+
+// Follows one crate through the moves without simulating any of the others
+// forward: where the crate at `start` ends up
+template <bool KeepOrder>
+Position traceForward(const Moves& moves, Position position) {
     for(const auto& move: moves){
-        auto& toStack = stacks[move.to];
-        auto& from = stacks[move.from];
-        toStack.insert(toStack.end(), from.end() - move.amount, from.end()); //NOLINT(bugprone-narrowing-conversions,cppcoreguidelines-narrowing-conversions)
-        from.erase(from.end() - move.amount, from.end()); //NOLINT(bugprone-narrowing-conversions,cppcoreguidelines-narrowing-conversions)
+        if(position.stack == move.from && position.depth < move.amount){
+            position.stack = move.to;
+            position.depth = KeepOrder ? position.depth : move.amount - 1 - position.depth;
+        }
+        else if(position.stack == move.from){
+            position.depth -= move.amount;
+        }
+        else if(position.stack == move.to){
+            position.depth += move.amount;
+        }
     }
-    return stacks;
+    return position;
 }
 
+// backward: which starting position ended up at `end`
+template <bool KeepOrder>
+Position traceBackward(const Moves& moves, Position position) {
+    for(const auto& move: std::views::reverse(moves)){
+        if(position.stack == move.to && position.depth < move.amount){
+            position.stack = move.from;
+            position.depth = KeepOrder ? position.depth : move.amount - 1 - position.depth;
+        }
+        else if(position.stack == move.to){
+            position.depth -= move.amount;
+        }
+        else if(position.stack == move.from){
+            position.depth += move.amount;
+        }
+    }
+    return position;
+}
 
+// Only the top crates matter, so trace each final top back to where it started:
+// O(moves * stacks) no matter how many crates there are. Empty stacks show as a space
+template <bool KeepOrder>
+std::string getTopOfStacks(const Moves& moves, const Stacks& stacks) {
+    std::vector<uint64_t> heights;
+    heights.reserve(stacks.size());
+    for(const auto& stack: stacks){
+        heights.push_back(stack.size());
+    }
+    for(const auto& move: moves){
+        heights[move.from] -= move.amount;
+        heights[move.to] += move.amount;
+    }
+
+    std::string tops;
+    for(size_t stack = 1; stack < stacks.size(); ++stack){
+        if(heights[stack] == 0){
+            tops += ' ';
+            continue;
+        }
+        auto origin = traceBackward<KeepOrder>(moves, Position{stack, 0});
+        const auto& originStack = stacks[origin.stack];
+        tops += originStack[originStack.size() - 1 - origin.depth];
+    }
+    return tops;
+}
 
-void printTopOfStacks(const Stacks& stacks) {
-    std::transform(stacks.begin() + 1, stacks.end(), std::ostream_iterator<char>(std::cout, ""), [](const auto& stack){
-        return stack.back();
+// the same answer read off fully replayed stacks
+std::string getTopOfStacks(const Stacks& stacks) {
+    std::string tops;
+    std::transform(stacks.begin() + 1, stacks.end(), std::back_inserter(tops), [](const auto& stack){
+        return stack.empty() ? ' ' : stack.back();
     });
-    std::cout << "\n";
+    return tops;
 }
 
+#ifdef DIFFERENTIAL
+// one crane's whole story: the tops, where every crate ends up and where every final spot's crate started
+// crates are listed stack by stack, top down
+struct Trace {
+    std::string tops;
+    std::vector<Position> ends;
+    std::vector<Position> origins;
+
+    friend bool operator==(const Trace&, const Trace&) = default;
+};
+
+// label every crate with where it started and let the ropes carry the labels around
+template <bool KeepOrder>
+Trace replayEveryCrate(const Moves& moves, const Stacks& stacks) {
+    std::vector<Position> starts;
+    std::vector<std::vector<size_t>> labels(stacks.size());
+    for(size_t stack = 0; stack < stacks.size(); ++stack){
+        labels[stack].resize(stacks[stack].size());
+        for(uint64_t depth = 0; depth < stacks[stack].size(); ++depth){
+            labels[stack][stacks[stack].size() - 1 - depth] = starts.size();
+            starts.push_back(Position{stack, depth});
+        }
+    }
+    auto replayed = replayMoves<KeepOrder>(moves, labels);
+
+    Trace trace {getTopOfStacks(KeepOrder ? apply9001StyleMoves(moves, stacks) : applyMoves(moves, stacks)), std::vector<Position>(starts.size()), {}};
+    for(size_t stack = 0; stack < replayed.size(); ++stack){
+        for(uint64_t depth = 0; depth < replayed[stack].size(); ++depth){
+            auto label = replayed[stack][replayed[stack].size() - 1 - depth];
+            trace.ends[label] = Position{stack, depth};
+            trace.origins.push_back(starts[label]);
+        }
+    }
+    return trace;
+}
+
+// the same story from tracing single crates, without ever building the stacks
+template <bool KeepOrder>
+Trace traceEveryCrate(const Moves& moves, const Stacks& stacks) {
+    Trace trace {getTopOfStacks<KeepOrder>(moves, stacks), {}, {}};
+    std::vector<uint64_t> heights;
+    for(size_t stack = 0; stack < stacks.size(); ++stack){
+        for(uint64_t depth = 0; depth < stacks[stack].size(); ++depth){
+            trace.ends.push_back(traceForward<KeepOrder>(moves, Position{stack, depth}));
+        }
+        heights.push_back(stacks[stack].size());
+    }
+    for(const auto& move: moves){
+        heights[move.from] -= move.amount;
+        heights[move.to] += move.amount;
+    }
+    for(size_t stack = 0; stack < heights.size(); ++stack){
+        for(uint64_t depth = 0; depth < heights[stack]; ++depth){
+            trace.origins.push_back(traceBackward<KeepOrder>(moves, Position{stack, depth}));
+        }
+    }
+    return trace;
+}
+
+int main() {
+    struct Case {
+        Stacks stacks;
+        Moves moves;
+    };
+    // `size` crates spread over a few stacks, then `size` moves that never take more than a stack holds
+    auto generate = [](auto& rng, size_t size){
+        std::uniform_int_distribution<size_t> numberOfStacks(2, 12);
+        std::uniform_int_distribution<int> letter('A', 'Z');
+        Case generated;
+        generated.stacks.resize(numberOfStacks(rng) + 1);
+        std::uniform_int_distribution<size_t> stack(1, generated.stacks.size() - 1);
+        for(size_t crate = 0; crate < size; ++crate){
+            generated.stacks[stack(rng)].push_back(static_cast<char>(letter(rng)));
+        }
+        std::vector<uint64_t> heights;
+        std::ranges::transform(generated.stacks, std::back_inserter(heights), [](const auto& crates){ return crates.size(); });
+        for(size_t index = 0; index < size; ++index){
+            Move move;
+            do {
+                move.from = stack(rng);
+            } while(heights[move.from] == 0);
+            do {
+                move.to = stack(rng);
+            } while(move.to == move.from);
+            move.amount = std::uniform_int_distribution<uint64_t>(1, heights[move.from])(rng);
+            heights[move.from] -= move.amount;
+            heights[move.to] += move.amount;
+            generated.moves.push_back(move);
+        }
+        return generated;
+    };
+    auto options = differential::getOptions({100, 1'000, 3'000});
+    bool passed = differential::run("challenge5", options, generate,
+        [](const Case& input){ return std::make_pair(replayEveryCrate<false>(input.moves, input.stacks), replayEveryCrate<true>(input.moves, input.stacks)); },
+        [](const Case& input){ return std::make_pair(traceEveryCrate<false>(input.moves, input.stacks), traceEveryCrate<true>(input.moves, input.stacks)); });
+    return passed ? 0 : 1;
+}
+#else
 int main() {
     auto lines = input::readLines("input/input5.txt");
     auto [stacks, moves] = parseInput(lines);
-    auto newStacks = applyMoves(moves, stacks);
-    printTopOfStacks(newStacks);
-
-    auto newStacks9001 = apply9001StyleMoves(moves, stacks);
-    printTopOfStacks(newStacks9001);
+    std::cout << getTopOfStacks<false>(moves, stacks) << "\n";
+    std::cout << getTopOfStacks<true>(moves, stacks) << "\n";
     return 0;
 }
-
+#endif
@@ -1,34 +1,136 @@
 #include <algorithm>
-#include <deque>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
-#include <ranges>
-#include <set>
 #include <string>
 #include <string_view>
 
+#include "embed.h"
 #include "input.h"
+#include "parallel.h"
 
-bool isUnique(const std::deque<char>& str){
-    const std::set<char> set{ str.begin(), str.end()};
-    return str.size() == set.size();
+// First marker for every window length at once, in one pass.
+// Tracks how long the run of all-different bytes ending here is (using where each byte was last seen);
+// a window of length k first fits at the first spot that run reaches k.
+// Gives back one past the end of each marker, or npos for a window that never fits. Every few thousand
+// bytes giveUp(window, end) is asked about the shortest window still waiting: once it can't do any good
+// from `end` on, that window is left at npos, and the scan stops when nothing is waiting
+template <size_t N, typename GiveUp>
+constexpr std::array<std::string::size_type, N> findMarkerEnds(std::string_view str, const std::array<std::string::size_type, N>& windows, GiveUp giveUp){
+    std::array<std::string::size_type, N> positions {};
+    positions.fill(std::string::npos);
 
+    // shortest windows get found first, so only ever check the shortest one still waiting
+    std::array<size_t, N> order {};
+    for(size_t index = 0; index < N; ++index){
+        order[index] = index;
+    }
+    std::ranges::sort(order, [&windows](size_t lhs, size_t rhs){ return windows[lhs] < windows[rhs]; });
+    size_t nextWindow = 0;
+    while(nextWindow < N && windows[order[nextWindow]] == 0){
+        positions[order[nextWindow++]] = 0;
+    }
+
+    // one past where each byte was last seen, 0 for never
+    std::array<std::string::size_type, 256> lastSeen {};
+    std::string::size_type runLength = 0;
+    for(std::string::size_type end = 0; end < str.size() && nextWindow < N; ++end){
+        if(end % 4096 == 0){
+            while(nextWindow < N && giveUp(order[nextWindow], end)){
+                ++nextWindow;
+            }
+            if(nextWindow == N){
+                break;
+            }
+        }
+        auto& seen = lastSeen[static_cast<unsigned char>(str[end])];
+        runLength = std::min(runLength + 1, end + 1 - seen);
+        seen = end + 1;
+        while(nextWindow < N && runLength >= windows[order[nextWindow]]){
+            positions[order[nextWindow++]] = end + 1;
+        }
+    }
+    return positions;
 }
 
-std::string::size_type getStartOfPacketPosition(std::string_view str, std::string::size_type num){
-    std::deque<char> candidate{str.begin(), str.begin()+num};
-    if (isUnique(candidate)){
-        return 0;
+// the whole buffer, windows that never fit come back as its size
+template <size_t N>
+constexpr std::array<std::string::size_type, N> getMarkerPositions(std::string_view str, const std::array<std::string::size_type, N>& windows){
+    auto positions = findMarkerEnds(str, windows, [](size_t, std::string::size_type){ return false; });
+    for(auto& position: positions){
+        position = (position == std::string::npos) ? str.size() : position;
     }
-    const auto* charIter = str.begin() + num;
-    for(; charIter != str.end() && !isUnique(candidate); ++charIter) {  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-        candidate.pop_front();
-        candidate.push_back(*charIter);
+    return positions;
+}
+
+// For huge captures: cut the buffer into segments that overlap by the longest window - 1 so no marker
+// gets lost at a seam. Workers take segments in order off a shared counter, so the earliest ones go
+// first, and every window's first marker so far is shared. A segment stops looking for a window once
+// it's past that window's best, and a segment starting past every best isn't searched at all
+template <size_t N>
+std::array<std::string::size_type, N> getMarkerPositionsInParallel(std::string_view str, const std::array<std::string::size_type, N>& windows, size_t segmentSize = 1U << 20U, parallel::ThreadPool& pool = parallel::getPool()){
+    const auto longest = N == 0 ? 0 : *std::ranges::max_element(windows);
+    segmentSize = std::max<size_t>(segmentSize, 1);
+    if(pool.size() == 1 || str.size() <= segmentSize + longest){
+        return getMarkerPositions(str, windows);
+    }
+    const size_t numberOfSegments = (str.size() - 1) / segmentSize + 1;
+    std::array<std::atomic<std::string::size_type>, N> best;
+    for(auto& position: best){
+        position = std::string::npos;
+    }
+    auto cannotBeat = [&best](size_t window, std::string::size_type position){
+        return position >= best[window].load(std::memory_order_relaxed);
+    };
+
+    std::atomic<size_t> nextSegment = 0;
+    parallel::TaskGroup group(pool);
+    for(size_t worker = 0; worker < pool.size(); ++worker){
+        group.run([&](){
+            for(auto segment = nextSegment++; segment < numberOfSegments; segment = nextSegment++){
+                const auto start = segment * segmentSize;
+                // segments only get later from here, so if this one's no use neither is any other
+                bool anyUseful = false;
+                for(size_t window = 0; window < N; ++window){
+                    anyUseful = anyUseful || !cannotBeat(window, start);
+                }
+                if(!anyUseful){
+                    return;
+                }
+                auto found = findMarkerEnds(str.substr(start, segmentSize + longest - 1), windows, [&](size_t window, std::string::size_type end){
+                    return cannotBeat(window, start + end);
+                });
+                for(size_t window = 0; window < N; ++window){
+                    if(found[window] == std::string::npos){
+                        continue;
+                    }
+                    auto position = start + found[window];
+                    auto current = best[window].load(std::memory_order_relaxed);
+                    while(position < current && !best[window].compare_exchange_weak(current, position, std::memory_order_relaxed)){}
+                }
+            }
+        });
+    }
+    group.wait();
+
+    std::array<std::string::size_type, N> positions {};
+    for(size_t window = 0; window < N; ++window){
+        auto position = best[window].load();
+        positions[window] = (position == std::string::npos) ? str.size() : position;
     }
-    return std::distance(str.begin(), charIter);
+    return positions;
 }
 
 int main() {
+#ifdef EMBED_INPUT_FILE
+    constexpr auto positions = getMarkerPositions<2>(input::embedded, {4, 14});
+#else
     auto str = input::readSingleLine("input/input6.txt");
-    std::cout << "Start of packet " << getStartOfPacketPosition(str, 4) << "\n";
-    std::cout << "Start of message " << getStartOfPacketPosition(str, 14) << "\n";
+    // one sweep is plenty until the capture is big enough to share out
+    constexpr size_t parallelThreshold = 1U << 24U;
+    auto positions = (str.size() < parallelThreshold) ? getMarkerPositions<2>(str, {4, 14}) : getMarkerPositionsInParallel<2>(str, {4, 14});
+#endif
+    std::cout << "Start of packet " << positions[0] << "\n";
+    std::cout << "Start of message " << positions[1] << "\n";
 }
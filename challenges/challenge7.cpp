@@ -10,6 +10,7 @@
 #include <string_view>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 #include "input.h"
 
@@ -41,6 +42,14 @@ public:
 
     FileTree() = default;
 
+    // children point back at their parent, so a tree can't be copied or moved out from under them;
+    // they're built in place in the map instead, where nodes never move
+    FileTree(const FileTree&) = delete;
+    FileTree& operator=(const FileTree&) = delete;
+    FileTree(FileTree&&) = delete;
+    FileTree& operator=(FileTree&&) = delete;
+    ~FileTree() = default;
+
     FileTree* cd(const std::string& subdirectory){
         if (subdirectory == "..") {
             if(!parent){
@@ -54,58 +63,52 @@ public:
     }
 
     void addSubdirectoryIfMissing(const std::string& subdirectory) {
-        if(leaves.find(subdirectory) == leaves.end()) {
-            leaves.try_emplace(subdirectory, FileTree{this});
+        auto [match, inserted] = leaves.try_emplace(subdirectory, std::in_place_type<FileTree>, this);
+        if(inserted) {
+            subdirectories.push_back(&std::get<FileTree>(match->second));
         }
     }
 
+    // sizes are kept up to date on the way in, so every directory always knows its total
     void addFile(std::string filename, size_t size) {
-        leaves.emplace(std::move(filename), size);
+        auto [_, inserted] = leaves.emplace(std::move(filename), size);
+        if(!inserted) {
+            return;
+        }
+        for(FileTree* directory = this; directory != nullptr; directory = directory->parent.value_or(nullptr)) {
+            directory->totalSize += size;
+        }
     }
 
     size_t getSmallFileSum() const {
-        auto mySize = getSize();
-        auto current = (mySize < 100'000) ? mySize : 0U;
-        return current + std::accumulate(leaves.begin(), leaves.end(), static_cast<size_t>(0), [](size_t sum, const auto& keyvalue){
-            auto [_, leaf] = keyvalue;
-            return sum + std::visit(overloaded {  // NOLINT(clang-diagnostic-error)
-                [](const FileTree& fileTree) { return fileTree.getSmallFileSum(); },
-                [](size_t ) { return static_cast<size_t>(0);}
-            }, leaf);
+        auto current = (totalSize < 100'000) ? totalSize : 0U;
+        return current + std::accumulate(subdirectories.begin(), subdirectories.end(), static_cast<size_t>(0), [](size_t sum, const FileTree* subdirectory){
+            return sum + subdirectory->getSmallFileSum();
         });
     }
     
     size_t findSmallestDirectorySizeToDelete(size_t target) const {
-        auto mySize = this->getSize();
-        if(mySize == 0) {
+        if(totalSize == 0) {
             return UINT64_MAX;
         }
-        std::vector<size_t> sizes;
-        std::transform(leaves.begin(), leaves.end(), std::back_inserter(sizes), [target](const auto& keyvalue){
-            auto [_, leaf] = keyvalue;
-            return std::visit(overloaded { // NOLINT(clang-diagnostic-error)
-                [target](const FileTree& fileTree) { return fileTree.findSmallestDirectorySizeToDelete(target); },
-                [](size_t ) { return static_cast<size_t>(UINT64_MAX);}
-            }, leaf);
-        });
-        return std::min(*std::min_element(sizes.begin(), sizes.end()), (mySize > target) ? mySize : UINT64_MAX);
+        size_t smallest = (totalSize > target) ? totalSize : UINT64_MAX;
+        for(const auto* subdirectory: subdirectories) {
+            smallest = std::min(smallest, subdirectory->findSmallestDirectorySizeToDelete(target));
+        }
+        return smallest;
     }
 
     size_t getSize() const { 
-        return std::accumulate(leaves.begin(), leaves.end(), static_cast<size_t>(0), [](size_t sum, const auto& keyvalue){
-            auto [_, leaf] = keyvalue;
-            return sum + std::visit(overloaded { // NOLINT(clang-diagnostic-error)
-                [](const FileTree& fileTree) { return fileTree.getSize(); },
-                [](size_t size ) { return size;}
-            }, leaf);
-        });
+        return totalSize;
     }
 
 
 
 private:
     std::unordered_map<std::string, Leaf> leaves;
+    std::vector<FileTree*> subdirectories;
     std::optional<FileTree*> parent;
+    size_t totalSize = 0;
     
     };
 
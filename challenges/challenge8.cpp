@@ -6,6 +6,7 @@
 #include <set>
 #include "grid.h"
 #include "input.h"
+#include "perfcounters.h"
 
 std::byte toByte(char symbol){
     return static_cast<std::byte>(symbol - 48);
@@ -131,11 +132,16 @@ unsigned int getScoreForMostScenicTree(auto& grid){
 
 int main() {
     Grid::Grid<std::byte> grid{toByte};
-    std::ifstream stream("input/input8.txt");
-    stream >> grid;
+    {
+        const perf::Phase phase("parse");
+        std::ifstream stream("input/input8.txt");
+        stream >> grid;
+    }
 
-    std::cout << "Trees visible: " << getNumberOfTreesVisible(grid) << "\n";
-    std::cout << "Most Scenic Score: " << getScoreForMostScenicTree(grid) << "\n";
+    auto treesVisible = perf::measure("trees visible", [&grid](){ return getNumberOfTreesVisible(grid); });
+    std::cout << "Trees visible: " << treesVisible << "\n";
+    auto scenicScore = perf::measure("most scenic score", [&grid](){ return getScoreForMostScenicTree(grid); });
+    std::cout << "Most Scenic Score: " << scenicScore << "\n";
 
 
     return 0;
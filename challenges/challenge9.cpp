@@ -1,12 +1,15 @@
 #include <cassert>
+#include <cmath>
 #include <istream>
 #include <iostream>
-#include <set>
+#include <random>
 #include <span>
 #include <string>
 #include <unordered_map>
 
+#include "differential.h"
 #include "grid.h"
+#include "hash.h"
 #include "input.h"
 
 Grid::Direction toDirection(char directionChar){
@@ -66,7 +69,7 @@ Grid::Coord getMoveTowards(const Grid::Coord& origin, const Grid::Coord& destina
 size_t getPositionsVisitedByTail(std::span<Move> moves, size_t numberOfKnots){
     Grid::Coord initial { 0, 0 };
     std::vector<Grid::Coord> positions {numberOfKnots, initial};
-    std::set<Grid::Coord> tailPositions{ initial };
+    hash::FlatSet<Grid::Coord> tailPositions{ initial };
     for(const auto& move: moves){
         for(unsigned int counter = 0; counter < move.moves; ++counter){
             positions[0] = positions[0] + move.direction;
@@ -79,10 +82,68 @@ size_t getPositionsVisitedByTail(std::span<Move> moves, size_t numberOfKnots){
     return tailPositions.size();
 }
 
+// same rules as getMoveTowards: once a knot is two away in any direction it steps
+// one towards the knot ahead of it along each axis
+Grid::Coord getStepTowards(const Grid::Coord& origin, const Grid::Coord& destination) {
+    auto difference = destination - origin;
+    if(std::abs(difference.xPos) <= 1 && std::abs(difference.yPos) <= 1) {
+        return {0, 0};
+    }
+    return {(difference.xPos > 0) - (difference.xPos < 0), (difference.yPos > 0) - (difference.yPos < 0)};
+}
+
+size_t getPositionsVisitedByTailFast(std::span<const Move> moves, size_t numberOfKnots){
+    Grid::Coord initial { 0, 0 };
+    std::vector<Grid::Coord> positions {numberOfKnots, initial};
+    hash::FlatSet<Grid::Coord> tailPositions{ initial };
+    for(const auto& move: moves){
+        for(unsigned int counter = 0; counter < move.moves; ++counter){
+            positions[0] = positions[0] + move.direction;
+            size_t knot = 1;
+            for (; knot < numberOfKnots; ++knot){
+                auto step = getStepTowards(positions[knot], positions[knot - 1]);
+                if(step == Grid::Coord{0, 0}){
+                    // nothing behind a knot that stayed put is going to move either
+                    break;
+                }
+                positions[knot] = positions[knot] + step;
+            }
+            if(knot == numberOfKnots){
+                tailPositions.insert(positions[numberOfKnots - 1]);
+            }
+        }
+    }
+    return tailPositions.size();
+}
+
+#ifdef DIFFERENTIAL
+int main() {
+    auto generate = [](auto& rng, size_t size){
+        std::vector<Move> moves;
+        std::uniform_int_distribution<int> direction(0, 3);
+        std::uniform_int_distribution<unsigned long> steps(1, 20);
+        for(size_t index = 0; index < size; ++index){
+            moves.push_back(Move{static_cast<Grid::Direction>(direction(rng)), steps(rng)});
+        }
+        return moves;
+    };
+    auto solve = [](auto solver){
+        return [solver](std::vector<Move> moves){
+            return std::make_pair(solver(moves, 2), solver(moves, 10));
+        };
+    };
+    auto options = differential::getOptions({100, 1'000, 10'000, 30'000});
+    bool passed = differential::run("challenge9", options, generate,
+        solve([](std::span<Move> moves, size_t knots){ return getPositionsVisitedByTail(moves, knots); }),
+        solve([](std::span<Move> moves, size_t knots){ return getPositionsVisitedByTailFast(moves, knots); }));
+    return passed ? 0 : 1;
+}
+#else
 int main() {
     auto moves = input::readLines<Move>("input/input9.txt");
-    std::cout << "Total Positions Visited By Tail: " << getPositionsVisitedByTail(moves, 2) << "\n";
-    std::cout << "Total Positions Visited By Tail(10): " << getPositionsVisitedByTail(moves, 10) << "\n";
+    std::cout << "Total Positions Visited By Tail: " << getPositionsVisitedByTailFast(moves, 2) << "\n";
+    std::cout << "Total Positions Visited By Tail(10): " << getPositionsVisitedByTailFast(moves, 10) << "\n";
 
 }
+#endif
 
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace arena {
+
+    // Bump allocator over a list of blocks. Deallocation is a no-op; reset() rewinds
+    // to the first block so the next generation reuses the same memory.
+    // Anything allocated from the arena must be gone (or never touched again) before reset()
+    class Arena : public std::pmr::memory_resource {
+    public:
+        explicit Arena(size_t blockSize = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+            : blockSize(blockSize), upstream(upstream) {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        ~Arena() override {
+            release();
+        }
+
+        // O(1), keeps every block around for the next generation
+        void reset() {
+            currentBlock = 0;
+            offset = 0;
+        }
+
+        // hand every block back to upstream
+        void release() {
+            for(const auto& block: blocks){
+                upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+            }
+            blocks.clear();
+            reset();
+        }
+
+        size_t capacity() const {
+            size_t total = 0;
+            for(const auto& block: blocks){
+                total += block.size;
+            }
+            return total;
+        }
+
+    private:
+        struct Block {
+            std::byte* data = nullptr;
+            size_t size = 0;
+        };
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            while(currentBlock < blocks.size()){
+                auto& block = blocks[currentBlock];
+                auto address = reinterpret_cast<std::uintptr_t>(block.data) + offset;  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                auto padding = (alignment - address % alignment) % alignment;
+                if(offset + padding + bytes <= block.size){
+                    offset += padding + bytes;
+                    return block.data + (offset - bytes); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                }
+                // doesn't fit, move on to the next block we already own
+                ++currentBlock;
+                offset = 0;
+            }
+
+            // oversized requests get a block of their own
+            auto size = std::max(blockSize, bytes + alignment);
+            blocks.push_back(Block{static_cast<std::byte*>(upstream->allocate(size, alignof(std::max_align_t))), size});
+            currentBlock = blocks.size() - 1;
+            offset = 0;
+            return do_allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void*, size_t, size_t) override {
+            // memory comes back all at once on reset
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        size_t blockSize;
+        std::pmr::memory_resource* upstream;
+        std::vector<Block> blocks;
+        size_t currentBlock = 0;
+        size_t offset = 0;
+    };
+
+    // Free lists for power-of-two size classes (8 bytes up to 512 bytes), carved out of
+    // slabs from upstream. Node-based containers (map, set, list) only ever ask for a
+    // handful of sizes, so freed nodes get recycled without going back to malloc.
+    // Bigger or over-aligned requests are passed straight through to upstream
+    class Pool : public std::pmr::memory_resource {
+    public:
+        explicit Pool(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource(), size_t slabSize = 64 * 1024)
+            : upstream(upstream), slabSize(slabSize) {}
+
+        Pool(const Pool&) = delete;
+        Pool& operator=(const Pool&) = delete;
+
+        ~Pool() override {
+            release();
+        }
+
+        // drop every free list and give the slabs back
+        void release() {
+            for(auto* slab: slabs){
+                upstream->deallocate(slab, slabSize, alignof(std::max_align_t));
+            }
+            slabs.clear();
+            freeLists.fill(nullptr);
+        }
+
+    private:
+        static constexpr size_t minimumSize = 8;
+        static constexpr size_t numberOfClasses = 7; // 8, 16, 32, 64, 128, 256, 512
+
+        struct FreeNode {
+            FreeNode* next;
+        };
+
+        static size_t getSizeClass(size_t bytes) {
+            return std::bit_width(std::max(bytes, minimumSize) - 1) - std::bit_width(minimumSize - 1);
+        }
+
+        static size_t getClassSize(size_t sizeClass) {
+            return minimumSize << sizeClass;
+        }
+
+        void refill(size_t sizeClass) {
+            auto* slab = static_cast<std::byte*>(upstream->allocate(slabSize, alignof(std::max_align_t)));
+            slabs.push_back(slab);
+            auto size = getClassSize(sizeClass);
+            for(size_t offset = 0; offset + size <= slabSize; offset += size){
+                auto* node = reinterpret_cast<FreeNode*>(slab + offset); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                node->next = freeLists[sizeClass];
+                freeLists[sizeClass] = node;
+            }
+        }
+
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            auto sizeClass = getSizeClass(bytes);
+            if(sizeClass >= numberOfClasses || alignment > alignof(std::max_align_t)){
+                return upstream->allocate(bytes, alignment);
+            }
+            if(!freeLists[sizeClass]){
+                refill(sizeClass);
+            }
+            auto* node = freeLists[sizeClass];
+            freeLists[sizeClass] = node->next;
+            return node;
+        }
+
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+            auto sizeClass = getSizeClass(bytes);
+            if(sizeClass >= numberOfClasses || alignment > alignof(std::max_align_t)){
+                upstream->deallocate(pointer, bytes, alignment);
+                return;
+            }
+            auto* node = static_cast<FreeNode*>(pointer);
+            node->next = freeLists[sizeClass];
+            freeLists[sizeClass] = node;
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        std::pmr::memory_resource* upstream;
+        size_t slabSize;
+        std::vector<std::byte*> slabs;
+        std::array<FreeNode*, numberOfClasses> freeLists {};
+    };
+} // namespace arena
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "hash.h"
+
+namespace cycle {
+
+    // after `start` steps the process repeats every `period` steps,
+    // and the measured quantity grows by `delta` every time around
+    template <typename Delta>
+    struct Cycle {
+        size_t start = 0;
+        size_t period = 0;
+        Delta delta {};
+    };
+
+    // All detectors take:
+    //   step(state)        advances the state in place by one step
+    //   fingerprint(state) something that compares equal exactly when two states behave the same
+    //                      from here on (leave out anything that only grows, like a height)
+    //   measure(state)     the quantity to extrapolate
+    //   maxSteps           give up (std::nullopt) once the state furthest ahead has taken this many steps
+    //                      without a repeat, so a process that never cycles can't run forever
+    constexpr size_t unbounded = std::numeric_limits<size_t>::max();
+
+    // Floyd's tortoise and hare, the hare takes two steps for every one of the tortoise
+    // keeps two states around, no history
+    template <typename State, typename Step, typename Fingerprint, typename Measure>
+    auto floyd(const State& initial, Step step, Fingerprint fingerprint, Measure measure, size_t maxSteps = unbounded) {
+        using Delta = decltype(measure(initial) - measure(initial));
+        State tortoise = initial;
+        State hare = initial;
+        size_t hareSteps = 0;
+        do {
+            if(maxSteps - hareSteps < 2){
+                return std::optional<Cycle<Delta>>{};
+            }
+            step(tortoise);
+            step(hare);
+            step(hare);
+            hareSteps += 2;
+        } while(fingerprint(tortoise) != fingerprint(hare));
+
+        // restart the tortoise; now they meet at the start of the cycle
+        tortoise = initial;
+        size_t start = 0;
+        while(fingerprint(tortoise) != fingerprint(hare)){
+            step(tortoise);
+            step(hare);
+            ++start;
+        }
+
+        // walk the hare around once to get the period and delta
+        size_t period = 0;
+        const auto startFingerprint = fingerprint(hare);
+        const auto startMeasure = measure(hare);
+        do {
+            step(hare);
+            ++period;
+        } while(fingerprint(hare) != startFingerprint);
+        return std::optional{Cycle<Delta>{start, period, measure(hare) - startMeasure}};
+    }
+
+    // Brent's algorithm: fewer steps than Floyd, and the tortoise is only ever a fingerprint
+    template <typename State, typename Step, typename Fingerprint, typename Measure>
+    auto brent(const State& initial, Step step, Fingerprint fingerprint, Measure measure, size_t maxSteps = unbounded) {
+        using Delta = decltype(measure(initial) - measure(initial));
+        if(maxSteps == 0){
+            return std::optional<Cycle<Delta>>{};
+        }
+        // find the period by teleporting the tortoise to the hare at every power of two
+        State hare = initial;
+        auto tortoise = fingerprint(hare);
+        step(hare);
+        size_t hareSteps = 1;
+        size_t power = 1;
+        size_t period = 1;
+        while(tortoise != fingerprint(hare)){
+            if(hareSteps == maxSteps){
+                return std::optional<Cycle<Delta>>{};
+            }
+            if(power == period){
+                tortoise = fingerprint(hare);
+                power *= 2;
+                period = 0;
+            }
+            step(hare);
+            ++hareSteps;
+            ++period;
+        }
+
+        // put the hare one period ahead and move both until they line up
+        State lagging = initial;
+        hare = initial;
+        for(size_t index = 0; index < period; ++index){
+            step(hare);
+        }
+        size_t start = 0;
+        while(fingerprint(lagging) != fingerprint(hare)){
+            step(lagging);
+            step(hare);
+            ++start;
+        }
+        return std::optional{Cycle<Delta>{start, period, measure(hare) - measure(lagging)}};
+    }
+
+    // one pass that remembers every fingerprint it has seen, trades memory for never re-simulating
+    template <typename State, typename Step, typename Fingerprint, typename Measure>
+    auto findByFingerprint(const State& initial, Step step, Fingerprint fingerprint, Measure measure, size_t maxSteps = unbounded) {
+        using Key = decltype(fingerprint(initial));
+        using Delta = decltype(measure(initial) - measure(initial));
+        hash::FlatMap<Key, std::pair<size_t, decltype(measure(initial))>> seen;
+        State state = initial;
+        for(size_t index = 0; ; ++index){
+            auto [match, inserted] = seen.try_emplace(fingerprint(state), index, measure(state));
+            if(!inserted){
+                auto [start, startMeasure] = match->second;
+                return std::optional{Cycle<Delta>{start, index - start, measure(state) - startMeasure}};
+            }
+            if(index == maxSteps){
+                return std::optional<Cycle<Delta>>{};
+            }
+            step(state);
+        }
+    }
+
+    // measure after `steps` steps, simulating at most start + period of them
+    template <typename State, typename Step, typename Measure, typename Delta>
+    auto extrapolate(const State& initial, Step step, Measure measure, const Cycle<Delta>& detected, size_t steps) {
+        State state = initial;
+        if(steps <= detected.start){
+            for(size_t index = 0; index < steps; ++index){
+                step(state);
+            }
+            return measure(state);
+        }
+        auto cycles = (steps - detected.start) / detected.period;
+        auto remainder = detected.start + (steps - detected.start) % detected.period;
+        for(size_t index = 0; index < remainder; ++index){
+            step(state);
+        }
+        return measure(state) + static_cast<Delta>(cycles) * detected.delta;
+    }
+} // namespace cycle
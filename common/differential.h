@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hash.h"
+
+// Runs a reference solver and a candidate side by side on generated inputs,
+// checks they agree and reports how much faster the candidate is at every size.
+//
+// Every case gets its own seed, and a mismatch prints it. To replay just that case:
+//     AOC_SEED=<seed> AOC_SIZE=<size> ./test
+// AOC_SEED on its own changes the base seed for a whole run
+namespace differential {
+
+    struct Options {
+        std::vector<size_t> sizes;
+        size_t casesPerSize = 3;
+        uint64_t baseSeed = 2022;
+        // set when replaying a single case
+        std::optional<uint64_t> replaySeed;
+        std::optional<size_t> replaySize;
+    };
+
+    std::optional<uint64_t> getEnvironmentNumber(const char* name) {
+        const char* fromEnvironment = std::getenv(name); // NOLINT(concurrency-mt-unsafe)
+        if(fromEnvironment == nullptr){
+            return {};
+        }
+        return std::stoull(fromEnvironment);
+    }
+
+    Options getOptions(std::vector<size_t> sizes, size_t casesPerSize = 3) {
+        Options options;
+        options.sizes = std::move(sizes);
+        options.casesPerSize = casesPerSize;
+        auto seed = getEnvironmentNumber("AOC_SEED");
+        auto size = getEnvironmentNumber("AOC_SIZE");
+        if(seed && size){
+            options.replaySeed = seed;
+            options.replaySize = size;
+        }
+        else if(seed){
+            options.baseSeed = *seed;
+        }
+        return options;
+    }
+
+    template <typename Func>
+    auto timeIt(Func func, double& milliseconds) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = func();
+        milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    // generate(rng, size) builds an input, reference(input) and candidate(input) must return equal answers
+    // returns false on the first mismatch
+    template <typename Generate, typename Reference, typename Candidate>
+    bool run(const std::string& name, const Options& options, Generate generate, Reference reference, Candidate candidate) {
+        auto runCase = [&](uint64_t seed, size_t size, double& referenceTime, double& candidateTime){
+            std::mt19937_64 rng(seed);
+            auto input = generate(rng, size);
+            auto expected = timeIt([&](){ return reference(input); }, referenceTime);
+            auto actual = timeIt([&](){ return candidate(input); }, candidateTime);
+            if(expected != actual){
+                std::cout << name << ": MISMATCH at size " << size << " seed " << seed << "\n"
+                          << "    replay with AOC_SEED=" << seed << " AOC_SIZE=" << size << "\n";
+                return false;
+            }
+            return true;
+        };
+
+        if(options.replaySeed){
+            double referenceTime = 0;
+            double candidateTime = 0;
+            bool passed = runCase(*options.replaySeed, *options.replaySize, referenceTime, candidateTime);
+            if(passed){
+                std::cout << name << ": seed " << *options.replaySeed << " size " << *options.replaySize << " matches\n";
+            }
+            return passed;
+        }
+
+        for(auto size: options.sizes){
+            double totalReference = 0;
+            double totalCandidate = 0;
+            for(size_t index = 0; index < options.casesPerSize; ++index){
+                auto seed = hash::hashValues(options.baseSeed, size, index);
+                double referenceTime = 0;
+                double candidateTime = 0;
+                if(!runCase(seed, size, referenceTime, candidateTime)){
+                    return false;
+                }
+                totalReference += referenceTime;
+                totalCandidate += candidateTime;
+            }
+            std::cout << name << ": size " << size << std::fixed << std::setprecision(3)
+                      << " reference " << totalReference / static_cast<double>(options.casesPerSize) << " ms"
+                      << " candidate " << totalCandidate / static_cast<double>(options.casesPerSize) << " ms"
+                      << " speedup " << std::setprecision(2) << totalReference / std::max(totalCandidate, 1e-6) << "x\n";
+        }
+        return true;
+    }
+} // namespace differential
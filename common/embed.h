@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string_view>
+
+// `make embed` turns input/inputN.txt into input/inputN.inc (the file wrapped in a raw string literal)
+// and builds with -DEMBED_INPUT_FILE="inputN.inc", so the input is available to constexpr code
+#ifdef EMBED_INPUT_FILE
+namespace input {
+    constexpr std::string_view embedded =
+#include EMBED_INPUT_FILE
+    ;
+} // namespace input
+#endif
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <algorithm>
 #include <cassert>
 #include <functional>
@@ -7,6 +9,7 @@
 #include <optional>
 #include <ranges>
 #include <utility>
+#include <vector>
 
 namespace Grid {
 
@@ -18,7 +21,7 @@ namespace Grid {
         Right
     };
 
-    Direction turn(Direction facing, Direction toTurn){
+    constexpr Direction turn(Direction facing, Direction toTurn){
         if(toTurn == Direction::Left){
             switch(facing){
                 case Direction::Up: return Direction::Left;
@@ -47,15 +50,15 @@ namespace Grid {
 
         std::strong_ordering operator<=>(const Coord& c2) const = default;
 
-        friend Coord operator+(const Coord& lhs, const Coord& rhs){
+        friend constexpr Coord operator+(const Coord& lhs, const Coord& rhs){
             return {lhs.xPos + rhs.xPos, lhs.yPos + rhs.yPos};
         }
 
-        friend Coord operator-(const Coord&lhs, const Coord& rhs){
+        friend constexpr Coord operator-(const Coord&lhs, const Coord& rhs){
             return lhs + Coord{-1*rhs.xPos, -1*rhs.yPos};
         }
 
-        friend Coord operator+(const Coord& lhs, Direction direction){
+        friend constexpr Coord operator+(const Coord& lhs, Direction direction){
             switch(direction){
                 case Direction::Up: { return lhs + Coord{0,-1}; }
                 case Direction::Down: { return lhs + Coord{0,1}; }
@@ -73,12 +76,14 @@ namespace Grid {
 
     };
 
-    unsigned int getManhattanDistance(const Coord& coord1, const Coord& coord2){
-        return abs(coord1.xPos - coord2.xPos) + abs(coord1.yPos - coord2.yPos);
+    constexpr unsigned int getManhattanDistance(const Coord& coord1, const Coord& coord2){
+        // gcc 12's libstdc++ doesn't mark std::abs constexpr yet, so spell it out
+        auto distance = [](int lhs, int rhs){ return static_cast<unsigned int>(lhs > rhs ? lhs - rhs : rhs - lhs); };
+        return distance(coord1.xPos, coord2.xPos) + distance(coord1.yPos, coord2.yPos);
     }
 
     // inclusive
-    std::vector<Coord> getPointsBetween(const Coord& coord1, const Coord& coord2){
+    constexpr std::vector<Coord> getPointsBetween(const Coord& coord1, const Coord& coord2){
         assert(coord1.xPos == coord2.xPos || coord1.yPos == coord2.yPos); // horizontal or vertical only
         std::vector<Coord> out;
         if(coord1.xPos == coord2.xPos){
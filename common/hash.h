@@ -0,0 +1,493 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "grid.h"
+
+namespace hash {
+
+    // splitmix64 finalizer, every input bit affects every output bit
+    constexpr uint64_t mix(uint64_t value) {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ULL;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebULL;
+        value ^= value >> 31;
+        return value;
+    }
+
+    constexpr uint64_t combine(uint64_t seed, uint64_t value) {
+        return mix(seed + 0x9e3779b97f4a7c15ULL + value);
+    }
+
+    // specialize this for your own types (or use hashValues in the specialization)
+    template <typename T>
+    struct Hash;
+
+    template <typename T>
+    concept Hashable = requires(const T& value) {
+        { Hash<T>{}(value) } -> std::convertible_to<uint64_t>;
+    };
+
+    template <typename T>
+    requires std::integral<T> || std::is_enum_v<T> || std::is_pointer_v<T>
+    struct Hash<T> {
+        constexpr uint64_t operator()(T value) const {
+            if constexpr(std::is_pointer_v<T>){
+                return mix(reinterpret_cast<std::uintptr_t>(value)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            }
+            else if constexpr(std::is_enum_v<T>){
+                return mix(static_cast<uint64_t>(static_cast<std::underlying_type_t<T>>(value)));
+            }
+            else {
+                return mix(static_cast<uint64_t>(value));
+            }
+        }
+    };
+
+    template <typename... Ts>
+    constexpr uint64_t hashValues(const Ts&... values) {
+        uint64_t seed = sizeof...(Ts);
+        ((seed = combine(seed, Hash<Ts>{}(values))), ...);
+        return seed;
+    }
+
+    template <>
+    struct Hash<Grid::Coord> {
+        constexpr uint64_t operator()(const Grid::Coord& coord) const {
+            // both halves fit in one word, so one mix is enough
+            return mix((static_cast<uint64_t>(static_cast<uint32_t>(coord.xPos)) << 32U) | static_cast<uint32_t>(coord.yPos));
+        }
+    };
+
+    template <typename First, typename Second>
+    struct Hash<std::pair<First, Second>> {
+        constexpr uint64_t operator()(const std::pair<First, Second>& pair) const {
+            return hashValues(pair.first, pair.second);
+        }
+    };
+
+    template <typename... Ts>
+    struct Hash<std::tuple<Ts...>> {
+        constexpr uint64_t operator()(const std::tuple<Ts...>& tuple) const {
+            return std::apply([](const auto&... values){ return hashValues(values...); }, tuple);
+        }
+    };
+
+    template <>
+    struct Hash<std::string_view> {
+        uint64_t operator()(std::string_view text) const {
+            // eight bytes at a time, the tail gets padded with zeroes
+            uint64_t seed = text.size();
+            size_t index = 0;
+            for(; index + 8 <= text.size(); index += 8){
+                uint64_t word = 0;
+                std::memcpy(&word, text.data() + index, 8); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                seed = combine(seed, word);
+            }
+            if(index < text.size()){
+                uint64_t word = 0;
+                std::memcpy(&word, text.data() + index, text.size() - index); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                seed = combine(seed, word);
+            }
+            return seed;
+        }
+    };
+
+    template <>
+    struct Hash<std::string> {
+        uint64_t operator()(const std::string& text) const {
+            return Hash<std::string_view>{}(text);
+        }
+    };
+
+    // fixed arrays, vectors, sets... anything you can iterate over that isn't a string
+    template <std::ranges::input_range Range>
+    requires (!std::convertible_to<Range, std::string_view>) && Hashable<std::ranges::range_value_t<Range>>
+    struct Hash<Range> {
+        constexpr uint64_t operator()(const Range& range) const {
+            uint64_t seed = 0;
+            for(const auto& value: range){
+                seed = combine(seed, Hash<std::ranges::range_value_t<Range>>{}(value));
+            }
+            return seed;
+        }
+    };
+
+    namespace detail {
+        struct SetTraits {
+            template <typename Value>
+            static const auto& getKey(const Value& value) { return value; }
+        };
+
+        struct MapTraits {
+            template <typename Value>
+            static const auto& getKey(const Value& value) { return value.first; }
+        };
+
+        // Open addressing with linear probing over one contiguous slot array.
+        // A parallel array of control bytes says whether a slot is full and caches
+        // seven bits of the hash, so most mismatches never touch the key.
+        // Erase shifts the following run back instead of leaving tombstones
+        template <typename Key, typename Value, typename Traits, typename HashFunc, typename Equal>
+        class FlatTable {
+        public:
+            using key_type = Key;
+            using value_type = Value;
+            using size_type = size_t;
+
+            template <bool IsConst>
+            class Iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Value;
+                using difference_type = std::ptrdiff_t;
+                using pointer = std::conditional_t<IsConst, const Value*, Value*>;
+                using reference = std::conditional_t<IsConst, const Value&, Value&>;
+
+                Iterator() = default;
+                Iterator(const FlatTable* table, size_t index) : table(table), index(index) {
+                    skipEmpty();
+                }
+                // iterator -> const_iterator
+                operator Iterator<true>() const requires (!IsConst) { return Iterator<true>(table, index); } // NOLINT(google-explicit-constructor)
+
+                reference operator*() const { return table->slots[index]; }
+                pointer operator->() const { return &table->slots[index]; }
+                Iterator& operator++() {
+                    ++index;
+                    skipEmpty();
+                    return *this;
+                }
+                Iterator operator++(int) {
+                    auto copy = *this;
+                    ++(*this);
+                    return copy;
+                }
+                friend bool operator==(const Iterator& lhs, const Iterator& rhs) { return lhs.index == rhs.index; }
+
+            private:
+                void skipEmpty() {
+                    while(index < table->controls.size() && table->controls[index] == emptySlot){
+                        ++index;
+                    }
+                }
+
+                const FlatTable* table = nullptr;
+                size_t index = 0;
+                friend class FlatTable;
+            };
+
+            using iterator = Iterator<std::is_same_v<Traits, SetTraits>>;
+            using const_iterator = Iterator<true>;
+
+            FlatTable() = default;
+
+            FlatTable(std::initializer_list<Value> values) {
+                reserve(values.size());
+                for(const auto& value: values){
+                    insert(value);
+                }
+            }
+
+            template <std::input_iterator InputIter>
+            FlatTable(InputIter first, InputIter last) {
+                for(; first != last; ++first){
+                    insert(*first);
+                }
+            }
+
+            FlatTable(const FlatTable& other) {
+                reserve(other.size());
+                for(const auto& value: other){
+                    insert(value);
+                }
+            }
+
+            FlatTable(FlatTable&& other) noexcept
+                : slots(std::exchange(other.slots, nullptr)), controls(std::move(other.controls)), numberOfEntries(std::exchange(other.numberOfEntries, 0)) {
+                other.controls.clear();
+            }
+
+            FlatTable& operator=(FlatTable other) noexcept {
+                swap(other);
+                return *this;
+            }
+
+            ~FlatTable() {
+                destroyAll();
+            }
+
+            void swap(FlatTable& other) noexcept {
+                std::swap(slots, other.slots);
+                std::swap(controls, other.controls);
+                std::swap(numberOfEntries, other.numberOfEntries);
+            }
+
+            size_t size() const { return numberOfEntries; }
+            bool empty() const { return numberOfEntries == 0; }
+            size_t capacity() const { return controls.size(); }
+
+            iterator begin() { return iterator(this, 0); }
+            iterator end() { return iterator(this, controls.size()); }
+            const_iterator begin() const { return const_iterator(this, 0); }
+            const_iterator end() const { return const_iterator(this, controls.size()); }
+
+            void clear() {
+                for(size_t index = 0; index < controls.size(); ++index){
+                    if(controls[index] != emptySlot){
+                        std::destroy_at(&slots[index]);
+                        controls[index] = emptySlot;
+                    }
+                }
+                numberOfEntries = 0;
+            }
+
+            // make room for this many entries without growing again
+            void reserve(size_t entries) {
+                size_t wanted = std::bit_ceil(std::max<size_t>(16, entries + entries / 4 + 1));
+                if(wanted > controls.size()){
+                    rehash(wanted);
+                }
+            }
+
+            iterator find(const Key& key) {
+                return iterator(this, findIndex(key));
+            }
+
+            const_iterator find(const Key& key) const {
+                return const_iterator(this, findIndex(key));
+            }
+
+            bool contains(const Key& key) const {
+                return findIndex(key) != controls.size();
+            }
+
+            size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+            std::pair<iterator, bool> insert(const Value& value) {
+                return emplaceWithKey(Traits::getKey(value), value);
+            }
+
+            std::pair<iterator, bool> insert(Value&& value) {
+                const Key& key = Traits::getKey(value);
+                return emplaceWithKey(key, std::move(value));
+            }
+
+            template <std::input_iterator InputIter>
+            void insert(InputIter first, InputIter last) {
+                for(; first != last; ++first){
+                    insert(*first);
+                }
+            }
+
+            // only defined for maps
+            template <typename... Args>
+            std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+                return emplaceWithKey(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+            }
+
+            template <typename... Args>
+            std::pair<iterator, bool> emplace(Args&&... args) {
+                Value value(std::forward<Args>(args)...);
+                return insert(std::move(value));
+            }
+
+            template <typename Mapped>
+            std::pair<iterator, bool> insert_or_assign(const Key& key, Mapped&& mapped) {
+                auto result = try_emplace(key, std::forward<Mapped>(mapped));
+                if(!result.second){
+                    result.first->second = std::forward<Mapped>(mapped);
+                }
+                return result;
+            }
+
+            auto& operator[](const Key& key) {
+                return try_emplace(key).first->second;
+            }
+
+            auto& at(const Key& key) {
+                auto index = findIndex(key);
+                if(index == controls.size()){
+                    throw std::out_of_range("hash::FlatMap::at: key not found");
+                }
+                return slots[index].second;
+            }
+
+            const auto& at(const Key& key) const {
+                auto index = findIndex(key);
+                if(index == controls.size()){
+                    throw std::out_of_range("hash::FlatMap::at: key not found");
+                }
+                return slots[index].second;
+            }
+
+            size_t erase(const Key& key) {
+                auto index = findIndex(key);
+                if(index == controls.size()){
+                    return 0;
+                }
+                eraseIndex(index);
+                return 1;
+            }
+
+            friend bool operator==(const FlatTable& lhs, const FlatTable& rhs) {
+                if(lhs.size() != rhs.size()){
+                    return false;
+                }
+                return std::ranges::all_of(lhs, [&rhs](const auto& value){
+                    auto match = rhs.find(Traits::getKey(value));
+                    return match != rhs.end() && *match == value;
+                });
+            }
+
+        private:
+            static constexpr uint8_t emptySlot = 0;
+
+            static uint64_t getHash(const Key& key) {
+                return HashFunc{}(key);
+            }
+
+            // high bit is always set so a full slot never looks empty
+            static uint8_t getControl(uint64_t hashValue) {
+                return static_cast<uint8_t>(hashValue >> 57U) | 0x80U;
+            }
+
+            size_t getMask() const {
+                return controls.size() - 1;
+            }
+
+            size_t findIndex(const Key& key) const {
+                if(numberOfEntries == 0){
+                    return controls.size();
+                }
+                auto hashValue = getHash(key);
+                auto control = getControl(hashValue);
+                for(auto index = hashValue & getMask(); controls[index] != emptySlot; index = (index + 1) & getMask()){
+                    if(controls[index] == control && Equal{}(Traits::getKey(slots[index]), key)){
+                        return index;
+                    }
+                }
+                return controls.size();
+            }
+
+            template <typename... Args>
+            std::pair<iterator, bool> emplaceWithKey(const Key& key, Args&&... args) {
+                auto hashValue = getHash(key);
+                auto control = getControl(hashValue);
+                if(!controls.empty()){
+                    auto index = hashValue & getMask();
+                    for(; controls[index] != emptySlot; index = (index + 1) & getMask()){
+                        if(controls[index] == control && Equal{}(Traits::getKey(slots[index]), key)){
+                            return {iterator(this, index), false};
+                        }
+                    }
+                    // keep the load factor under 7/8
+                    if((numberOfEntries + 1) * 8 <= controls.size() * 7){
+                        constructAt(index, control, std::forward<Args>(args)...);
+                        return {iterator(this, index), true};
+                    }
+                }
+                // growing moves every slot, and key or args may live in one (insert(*it), try_emplace(key, it->second)),
+                // so build the new value before anything moves
+                Value value(std::forward<Args>(args)...);
+                rehash(std::max<size_t>(16, controls.size() * 2));
+                auto index = findEmptyIndex(hashValue);
+                constructAt(index, control, std::move(value));
+                return {iterator(this, index), true};
+            }
+
+            size_t findEmptyIndex(uint64_t hashValue) const {
+                auto index = hashValue & getMask();
+                while(controls[index] != emptySlot){
+                    index = (index + 1) & getMask();
+                }
+                return index;
+            }
+
+            template <typename... Args>
+            void constructAt(size_t index, uint8_t control, Args&&... args) {
+                std::construct_at(&slots[index], std::forward<Args>(args)...);
+                controls[index] = control;
+                ++numberOfEntries;
+            }
+
+            void eraseIndex(size_t index) {
+                std::destroy_at(&slots[index]);
+                controls[index] = emptySlot;
+                --numberOfEntries;
+                // backward shift: pull later entries of the run into the hole if their home is at or before it
+                auto hole = index;
+                for(auto next = (hole + 1) & getMask(); controls[next] != emptySlot; next = (next + 1) & getMask()){
+                    auto home = getHash(Traits::getKey(slots[next])) & getMask();
+                    auto distanceToNext = (next - home) & getMask();
+                    auto distanceToHole = (next - hole) & getMask();
+                    if(distanceToNext >= distanceToHole){
+                        std::construct_at(&slots[hole], std::move(slots[next]));
+                        std::destroy_at(&slots[next]);
+                        controls[hole] = controls[next];
+                        controls[next] = emptySlot;
+                        hole = next;
+                    }
+                }
+            }
+
+            void rehash(size_t newCapacity) {
+                auto oldSlots = std::exchange(slots, allocator.allocate(newCapacity));
+                auto oldControls = std::exchange(controls, std::vector<uint8_t>(newCapacity, emptySlot));
+                numberOfEntries = 0;
+                for(size_t index = 0; index < oldControls.size(); ++index){
+                    if(oldControls[index] != emptySlot){
+                        // keys are already unique, so just find each one a free slot
+                        auto& value = oldSlots[index];
+                        auto hashValue = getHash(Traits::getKey(value));
+                        constructAt(findEmptyIndex(hashValue), getControl(hashValue), std::move(value));
+                        std::destroy_at(&value);
+                    }
+                }
+                if(oldSlots){
+                    allocator.deallocate(oldSlots, oldControls.size());
+                }
+            }
+
+            void destroyAll() {
+                if(!slots){
+                    return;
+                }
+                clear();
+                allocator.deallocate(slots, controls.size());
+                slots = nullptr;
+            }
+
+            [[no_unique_address]] std::allocator<Value> allocator;
+            Value* slots = nullptr;
+            std::vector<uint8_t> controls;
+            size_t numberOfEntries = 0;
+        };
+    } // namespace detail
+
+    template <typename Key, typename Value, typename HashFunc = Hash<Key>, typename Equal = std::equal_to<Key>>
+    using FlatMap = detail::FlatTable<Key, std::pair<const Key, Value>, detail::MapTraits, HashFunc, Equal>;
+
+    template <typename Key, typename HashFunc = Hash<Key>, typename Equal = std::equal_to<Key>>
+    using FlatSet = detail::FlatTable<Key, Key, detail::SetTraits, HashFunc, Equal>;
+} // namespace hash
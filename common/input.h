@@ -1,9 +1,20 @@
+#pragma once
+
 #include <concepts>
+#include <cstddef>
 #include <fstream>
+#include <iterator>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#ifdef __linux__
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 template<typename T>
 concept InputStreamable = requires(T t, std::istream& is){
     is >> t;
@@ -13,6 +24,41 @@ template<typename T>
 concept StreamInitializable = std::default_initializable<T> && std::copy_constructible<T> && InputStreamable<T>;
 
 namespace input {
+
+    // whole file in one go, empty if it can't be opened
+    std::optional<std::string> readFile(const std::string& filename) {
+#ifdef __linux__
+        // fopen rather than open: fcntl.h drags in names like tee that challenges use themselves
+        std::FILE* file = std::fopen(filename.c_str(), "rbe"); // NOLINT(cppcoreguidelines-owning-memory)
+        if(file == nullptr){
+            return {};
+        }
+        const int descriptor = fileno(file);
+        struct stat status {};
+        std::optional<std::string> contents;
+        if(fstat(descriptor, &status) == 0){
+            contents.emplace(static_cast<size_t>(status.st_size), '\0');
+            size_t offset = 0;
+            while(offset < contents->size()){
+                auto bytesRead = pread(descriptor, contents->data() + offset, contents->size() - offset, static_cast<off_t>(offset));
+                if(bytesRead <= 0){
+                    break;
+                }
+                offset += static_cast<size_t>(bytesRead);
+            }
+            contents->resize(offset);
+        }
+        std::fclose(file); // NOLINT(cppcoreguidelines-owning-memory)
+        return contents;
+#else
+        std::ifstream in(filename, std::ios::binary);
+        if(!in){
+            return {};
+        }
+        return std::string(std::istreambuf_iterator<char>(in), {});
+#endif
+    }
+
     template <StreamInitializable T=std::string>
     std::vector<T> readLines(const std::string& filename){
         std::vector<T> lines;
@@ -38,7 +84,7 @@ namespace input {
 
     }
 
-    std::vector<std::string> split(const std::string& text, const std::string& delimiter) {
+    constexpr std::vector<std::string> split(const std::string& text, const std::string& delimiter) {
         std::vector<std::string> out;
         std::string::size_type pos;
         std::string::size_type start;
@@ -52,4 +98,15 @@ namespace input {
         }
         return out;
     }
+
+    // every line of an in-memory input, trailing newline or not
+    constexpr std::vector<std::string_view> splitLines(std::string_view text) {
+        std::vector<std::string_view> lines;
+        while(!text.empty()){
+            auto end = text.find('\n');
+            lines.push_back(text.substr(0, end));
+            text = (end == std::string_view::npos) ? std::string_view{} : text.substr(end + 1);
+        }
+        return lines;
+    }
 } // namespace input
\ No newline at end of file
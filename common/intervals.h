@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace intervals {
+
+    // A set of integers stored as disjoint, sorted, inclusive [start, end] runs.
+    // Touching or overlapping runs are merged as they're inserted, so starts and ends
+    // are both strictly increasing and each lives in its own flat array for binary search.
+    // Lookups are O(log n). Inserting finds its spot in O(log n) but then shifts the arrays,
+    // so it's O(n) worst case: cheap for the few dozen runs these puzzles keep, not for millions
+    template <std::integral T>
+    class IntervalSet {
+    public:
+        void insert(T start, T end) {
+            if(start > end){
+                return;
+            }
+            // first run that touches or comes after [start, end] (nothing ends before the lowest value)
+            auto first = static_cast<size_t>(std::ranges::lower_bound(ends, start, [](T runEnd, T value){
+                return value != std::numeric_limits<T>::min() && runEnd < value - 1;
+            }) - ends.begin());
+            // first run that starts clear past [start, end] (nothing starts after the highest value)
+            auto last = static_cast<size_t>(std::ranges::upper_bound(starts, end, [](T value, T runStart){
+                return value != std::numeric_limits<T>::max() && value + 1 < runStart;
+            }) - starts.begin());
+
+            if(first < last){
+                start = std::min(start, starts[first]);
+                end = std::max(end, ends[last - 1]);
+                for(auto index = first; index < last; ++index){
+                    coveredLength -= ends[index] - starts[index] + 1;
+                }
+                starts.erase(starts.begin() + static_cast<std::ptrdiff_t>(first), starts.begin() + static_cast<std::ptrdiff_t>(last));
+                ends.erase(ends.begin() + static_cast<std::ptrdiff_t>(first), ends.begin() + static_cast<std::ptrdiff_t>(last));
+            }
+            starts.insert(starts.begin() + static_cast<std::ptrdiff_t>(first), start);
+            ends.insert(ends.begin() + static_cast<std::ptrdiff_t>(first), end);
+            coveredLength += end - start + 1;
+        }
+
+        void insert(const std::pair<T, T>& range) {
+            insert(range.first, range.second);
+        }
+
+        // keeps the storage around for the next round
+        void clear() {
+            starts.clear();
+            ends.clear();
+            coveredLength = 0;
+        }
+
+        bool contains(T value) const {
+            auto index = findRun(value);
+            return index != ends.size() && starts[index] <= value;
+        }
+
+        // whole of [start, end] is covered
+        bool contains(T start, T end) const {
+            auto index = findRun(start);
+            return index != ends.size() && starts[index] <= start && ends[index] >= end;
+        }
+
+        // total number of integers covered
+        T getCoveredLength() const {
+            return coveredLength;
+        }
+
+        // integers of [start, end] that are covered
+        T getCoveredLength(T start, T end) const {
+            T total = 0;
+            for(auto index = findRun(start); index < ends.size() && starts[index] <= end; ++index){
+                total += std::min(end, ends[index]) - std::max(start, starts[index]) + 1;
+            }
+            return total;
+        }
+
+        // lowest integer in [start, end] that isn't covered
+        std::optional<T> getFirstGap(T start, T end) const {
+            auto index = findRun(start);
+            if(index == ends.size() || starts[index] > start){
+                return start <= end ? std::optional<T>{start} : std::nullopt;
+            }
+            // runs never touch, so whatever comes right after this run is free
+            if(ends[index] >= end){
+                return std::nullopt;
+            }
+            return ends[index] + 1;
+        }
+
+        // number of runs that share at least one integer with [start, end]
+        size_t countOverlapping(T start, T end) const {
+            auto first = findRun(start);
+            auto last = static_cast<size_t>(std::ranges::upper_bound(starts, end) - starts.begin());
+            return last > first ? last - first : 0;
+        }
+
+        size_t size() const {
+            return starts.size();
+        }
+
+        bool empty() const {
+            return starts.empty();
+        }
+
+        std::pair<T, T> operator[](size_t index) const {
+            return {starts[index], ends[index]};
+        }
+
+    private:
+        // first run that ends at or after value
+        size_t findRun(T value) const {
+            return static_cast<size_t>(std::ranges::lower_bound(ends, value) - ends.begin());
+        }
+
+        std::vector<T> starts;
+        std::vector<T> ends;
+        T coveredLength = 0;
+    };
+
+    // A fixed set of inclusive [start, end] intervals, overlaps allowed, built once and then queried.
+    // Counting needs nothing but the starts and the ends in two sorted arrays: everything that
+    // starts by `last` overlaps [start, last] unless it also ends before `start`. That's O(log n).
+    // Listing the overlaps splits them in two: the intervals containing `start`, and the ones
+    // starting inside (start, last], which sit next to each other in the sorted starts.
+    // The first lot comes from a centered interval tree. Every node keeps the intervals that
+    // straddle its center, sorted by start and again by end, so a walk down the tree only reads
+    // entries it reports plus one per node. Listing k intervals is O(log n + k)
+    template <std::integral T>
+    class StaticIntervalIndex {
+    public:
+        // ids are positions in the vector passed in
+        explicit StaticIntervalIndex(const std::vector<std::pair<T, T>>& intervals) {
+            ids.resize(intervals.size());
+            for(size_t index = 0; index < ids.size(); ++index){
+                ids[index] = index;
+            }
+            std::ranges::sort(ids, [&intervals](size_t lhs, size_t rhs){ return intervals[lhs].first < intervals[rhs].first; });
+
+            starts.reserve(ids.size());
+            ends.reserve(ids.size());
+            for(auto id: ids){
+                starts.push_back(intervals[id].first);
+                ends.push_back(intervals[id].second);
+            }
+            sortedEnds = ends;
+            std::ranges::sort(sortedEnds);
+
+            std::vector<size_t> everything(ids.size());
+            for(size_t index = 0; index < everything.size(); ++index){
+                everything[index] = index;
+            }
+            root = buildNode(std::move(everything));
+
+            // sorted by start already, so the union is one sweep
+            std::optional<std::pair<T, T>> run;
+            for(size_t index = 0; index < starts.size(); ++index){
+                if(run && (run->second == std::numeric_limits<T>::max() || starts[index] <= run->second + 1)){
+                    run->second = std::max(run->second, ends[index]);
+                    continue;
+                }
+                if(run){
+                    coveredLength += run->second - run->first + 1;
+                }
+                run = {starts[index], ends[index]};
+            }
+            if(run){
+                coveredLength += run->second - run->first + 1;
+            }
+        }
+
+        // func(id, start, end) for every interval sharing at least one integer with [start, last]
+        template <typename Func>
+        void forEachOverlapping(T start, T last, Func func) const {
+            if(start > last){
+                return;
+            }
+            forEachContaining(start, func);
+            auto first = std::ranges::upper_bound(starts, start) - starts.begin();
+            auto stop = std::ranges::upper_bound(starts, last) - starts.begin();
+            for(auto index = static_cast<size_t>(first); index < static_cast<size_t>(stop); ++index){
+                func(ids[index], starts[index], ends[index]);
+            }
+        }
+
+        template <typename Func>
+        void forEachContaining(T value, Func func) const {
+            auto report = [this, &func](size_t index){ func(ids[index], starts[index], ends[index]); };
+            for(auto node = root; node != noNode; ){
+                const auto& current = nodes[node];
+                if(value < current.center){
+                    // everything here reaches the center, so it holds value iff it starts early enough
+                    for(auto index = current.begin; index < current.end && starts[byStart[index]] <= value; ++index){
+                        report(byStart[index]);
+                    }
+                    node = current.left;
+                }
+                else if(value > current.center){
+                    for(auto index = current.begin; index < current.end && ends[byEnd[index]] >= value; ++index){
+                        report(byEnd[index]);
+                    }
+                    node = current.right;
+                }
+                else {
+                    for(auto index = current.begin; index < current.end; ++index){
+                        report(byStart[index]);
+                    }
+                    return;
+                }
+            }
+        }
+
+        std::vector<size_t> findOverlapping(T start, T last) const {
+            std::vector<size_t> found;
+            forEachOverlapping(start, last, [&found](size_t id, T, T){ found.push_back(id); });
+            return found;
+        }
+
+        size_t countOverlapping(T start, T last) const {
+            if(start > last){
+                return 0;
+            }
+            auto startedInTime = std::ranges::upper_bound(starts, last) - starts.begin();
+            auto endedTooSoon = std::ranges::lower_bound(sortedEnds, start) - sortedEnds.begin();
+            return static_cast<size_t>(startedInTime - endedTooSoon);
+        }
+
+        size_t countContaining(T value) const {
+            return countOverlapping(value, value);
+        }
+
+        // integers covered by at least one interval
+        T getCoveredLength() const {
+            return coveredLength;
+        }
+
+        size_t size() const {
+            return starts.size();
+        }
+
+    private:
+        static constexpr size_t noNode = std::numeric_limits<size_t>::max();
+
+        // [begin, end) of byStart and byEnd hold the intervals straddling center
+        struct Node {
+            T center {};
+            size_t left = noNode;
+            size_t right = noNode;
+            size_t begin = 0;
+            size_t end = 0;
+        };
+
+        // members are positions in the start-sorted arrays, in increasing order
+        size_t buildNode(std::vector<size_t> members) {
+            if(members.empty()){
+                return noNode;
+            }
+            // the median endpoint: at most half the intervals can lie wholly on either side of it
+            std::vector<T> endpoints;
+            endpoints.reserve(members.size() * 2);
+            for(auto member: members){
+                endpoints.push_back(starts[member]);
+                endpoints.push_back(ends[member]);
+            }
+            auto median = endpoints.begin() + static_cast<std::ptrdiff_t>(members.size());
+            std::ranges::nth_element(endpoints, median);
+
+            Node node {.center = *median};
+            std::vector<size_t> left;
+            std::vector<size_t> right;
+            std::vector<size_t> straddling;
+            for(auto member: members){
+                if(ends[member] < node.center){
+                    left.push_back(member);
+                }
+                else if(starts[member] > node.center){
+                    right.push_back(member);
+                }
+                else {
+                    straddling.push_back(member);
+                }
+            }
+            node.begin = byStart.size();
+            node.end = node.begin + straddling.size();
+            byStart.insert(byStart.end(), straddling.begin(), straddling.end());
+            std::ranges::stable_sort(straddling, [this](size_t lhs, size_t rhs){ return ends[lhs] > ends[rhs]; });
+            byEnd.insert(byEnd.end(), straddling.begin(), straddling.end());
+
+            auto index = nodes.size();
+            nodes.push_back(node);
+            auto leftChild = buildNode(std::move(left));
+            auto rightChild = buildNode(std::move(right));
+            nodes[index].left = leftChild;
+            nodes[index].right = rightChild;
+            return index;
+        }
+
+        std::vector<T> starts;
+        std::vector<T> ends;
+        std::vector<T> sortedEnds;
+        std::vector<size_t> ids;
+        std::vector<Node> nodes;
+        std::vector<size_t> byStart;
+        std::vector<size_t> byEnd;
+        size_t root = noNode;
+        T coveredLength = 0;
+    };
+} // namespace intervals
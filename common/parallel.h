@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace parallel {
+
+    // number of worker threads, AOC_THREADS overrides the hardware count
+    size_t getDefaultThreadCount() {
+        const char* fromEnvironment = std::getenv("AOC_THREADS"); // NOLINT(concurrency-mt-unsafe)
+        if(fromEnvironment != nullptr){
+            auto requested = std::strtoul(fromEnvironment, nullptr, 10);
+            if(requested > 0){
+                return requested;
+            }
+        }
+        return std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    // Every worker owns a deque. Workers push and pop their own work at the back and
+    // steal from the front of everyone else's when they run dry
+    class ThreadPool {
+    public:
+        explicit ThreadPool(size_t numberOfThreads = getDefaultThreadCount()) {
+            for(size_t index = 0; index < numberOfThreads; ++index){
+                queues.push_back(std::make_unique<Queue>());
+            }
+            for(size_t index = 0; index < numberOfThreads; ++index){
+                threads.emplace_back([this, index](){ workerLoop(index); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                const std::lock_guard lock(sleepMutex);
+                stopping = true;
+            }
+            wakeUp.notify_all();
+            for(auto& thread: threads){
+                thread.join();
+            }
+        }
+
+        size_t size() const {
+            return queues.size();
+        }
+
+        void submit(std::function<void()> task) {
+            // tasks spawned from a worker stay local, everything else gets spread out
+            auto index = (currentPool == this) ? currentIndex : nextQueue++ % queues.size();
+            {
+                // count it under the queue lock so nobody can pop it (and decrement) first,
+                // and under the sleep lock so a worker about to wait can't miss it
+                const std::scoped_lock lock(sleepMutex, queues[index]->mutex);
+                queues[index]->tasks.push_back(std::move(task));
+                ++pending;
+            }
+            wakeUp.notify_one();
+        }
+
+        // run one queued task on the calling thread, if there is any
+        // this is how waiting threads help out instead of blocking
+        bool runPendingTask() {
+            auto start = (currentPool == this) ? currentIndex : 0;
+            auto task = popTask(start);
+            if(!task){
+                return false;
+            }
+            task();
+            return true;
+        }
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::function<void()> popTask(size_t start) {
+            {
+                auto& own = *queues[start];
+                const std::lock_guard lock(own.mutex);
+                if(!own.tasks.empty()){
+                    auto task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    --pending;
+                    return task;
+                }
+            }
+            for(size_t offset = 1; offset < queues.size(); ++offset){
+                auto& victim = *queues[(start + offset) % queues.size()];
+                const std::lock_guard lock(victim.mutex);
+                if(!victim.tasks.empty()){
+                    auto task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    --pending;
+                    return task;
+                }
+            }
+            return {};
+        }
+
+        void workerLoop(size_t index) {
+            currentPool = this;
+            currentIndex = index;
+            while(true){
+                if(runPendingTask()){
+                    continue;
+                }
+                std::unique_lock lock(sleepMutex);
+                wakeUp.wait(lock, [this](){ return stopping || pending > 0; });
+                if(stopping){
+                    return;
+                }
+            }
+        }
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> threads;
+        std::atomic<size_t> nextQueue = 0;
+        std::atomic<size_t> pending = 0;
+        std::mutex sleepMutex;
+        std::condition_variable wakeUp;
+        bool stopping = false;
+
+        static inline thread_local ThreadPool* currentPool = nullptr;
+        static inline thread_local size_t currentIndex = 0;
+    };
+
+    ThreadPool& getPool() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // fork/join: run() any number of tasks, wait() until they're all done
+    // the first exception thrown by a task is rethrown from wait()
+    class TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool& pool = getPool()) : pool(pool) {}
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        ~TaskGroup() {
+            waitForOutstanding();
+        }
+
+        template <typename Func>
+        void run(Func&& func) {
+            ++outstanding;
+            pool.submit([this, func=std::forward<Func>(func)](){
+                try {
+                    func();
+                }
+                catch(...) {
+                    const std::lock_guard lock(exceptionMutex);
+                    if(!exception){
+                        exception = std::current_exception();
+                    }
+                }
+                // notify under the lock, once outstanding hits 0 the group may be destroyed
+                const std::lock_guard lock(doneMutex);
+                --outstanding;
+                finished.notify_all();
+            });
+        }
+
+        void wait() {
+            waitForOutstanding();
+            if(exception){
+                std::rethrow_exception(std::exchange(exception, nullptr));
+            }
+        }
+
+    private:
+        void waitForOutstanding() {
+            while(outstanding > 0){
+                if(pool.runPendingTask()){
+                    continue;
+                }
+                // nothing to help with, sleep until one of ours finishes and look again
+                std::unique_lock lock(doneMutex);
+                auto seen = outstanding.load();
+                if(seen > 0){
+                    finished.wait(lock, [this, seen](){ return outstanding != seen; });
+                }
+            }
+            // the task that took outstanding to 0 may still be notifying, don't let the group die under it
+            const std::lock_guard lock(doneMutex);
+        }
+
+        ThreadPool& pool;
+        std::atomic<size_t> outstanding = 0;
+        std::mutex doneMutex;
+        std::condition_variable finished;
+        std::mutex exceptionMutex;
+        std::exception_ptr exception;
+    };
+
+    // splits [begin, end) into chunks of at least grainSize, func is called with every index
+    // a grainSize of 0 picks a chunk size that gives each thread a few chunks to balance with
+    template <typename Func>
+    void parallelFor(size_t begin, size_t end, Func func, size_t grainSize = 0, ThreadPool& pool = getPool()) {
+        if(begin >= end){
+            return;
+        }
+        auto count = end - begin;
+        if(grainSize == 0){
+            grainSize = std::max<size_t>(1, count / (pool.size() * 4));
+        }
+        if(pool.size() == 1 || count <= grainSize){
+            for(auto index = begin; index < end; ++index){
+                func(index);
+            }
+            return;
+        }
+
+        TaskGroup group(pool);
+        for(auto chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize){
+            auto chunkEnd = std::min(end, chunkBegin + grainSize);
+            group.run([&func, chunkBegin, chunkEnd](){
+                for(auto index = chunkBegin; index < chunkEnd; ++index){
+                    func(index);
+                }
+            });
+        }
+        group.wait();
+    }
+
+    // map every index in [begin, end) and fold the results together
+    // chunks are combined left to right, so reduce only needs to be associative
+    template <typename T, typename Map, typename Reduce>
+    T parallelReduce(size_t begin, size_t end, T init, Map map, Reduce reduce, size_t grainSize = 0, ThreadPool& pool = getPool()) {
+        if(begin >= end){
+            return init;
+        }
+        auto count = end - begin;
+        if(grainSize == 0){
+            grainSize = std::max<size_t>(1, count / (pool.size() * 4));
+        }
+        auto numberOfChunks = (count + grainSize - 1) / grainSize;
+        std::vector<std::optional<T>> partials(numberOfChunks);
+        parallelFor(0, numberOfChunks, [&](size_t chunk){
+            auto chunkBegin = begin + chunk * grainSize;
+            auto chunkEnd = std::min(end, chunkBegin + grainSize);
+            T partial = map(chunkBegin);
+            for(auto index = chunkBegin + 1; index < chunkEnd; ++index){
+                partial = reduce(std::move(partial), map(index));
+            }
+            partials[chunk] = std::move(partial);
+        }, 1, pool);
+
+        for(auto& partial: partials){
+            init = reduce(std::move(init), std::move(*partial));
+        }
+        return init;
+    }
+} // namespace parallel
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Opt-in hardware counters around solver phases. Set AOC_PERF=1 to turn them on;
+// otherwise a Phase just holds its name and never starts a clock. If the kernel won't
+// let us open a counter (perf_event_paranoid, containers without CAP_PERFMON, non-Linux...)
+// that counter shows up as n/a and everything else still runs
+namespace perf {
+
+    enum class Counter {
+        Cycles,
+        Instructions,
+        L1DataMisses,
+        LastLevelCacheMisses,
+        BranchMisses
+    };
+
+    constexpr std::array<Counter, 5> allCounters {Counter::Cycles, Counter::Instructions, Counter::L1DataMisses, Counter::LastLevelCacheMisses, Counter::BranchMisses};
+
+    bool isEnabled() {
+        static const bool enabled = [](){
+            const char* fromEnvironment = std::getenv("AOC_PERF"); // NOLINT(concurrency-mt-unsafe)
+            return fromEnvironment != nullptr && std::string(fromEnvironment) != "0";
+        }();
+        return enabled;
+    }
+
+    struct Counts {
+        std::array<std::optional<uint64_t>, allCounters.size()> values;
+        std::chrono::duration<double, std::milli> elapsed {};
+
+        std::optional<uint64_t> operator[](Counter counter) const {
+            return values[static_cast<size_t>(counter)];
+        }
+    };
+
+    class Counters {
+    public:
+        Counters() {
+            for(auto counter: allCounters){
+                descriptors[static_cast<size_t>(counter)] = open(counter);
+            }
+        }
+
+        Counters(const Counters&) = delete;
+        Counters& operator=(const Counters&) = delete;
+
+        ~Counters() {
+#ifdef __linux__
+            for(auto descriptor: descriptors){
+                if(descriptor >= 0){
+                    close(descriptor);
+                }
+            }
+#endif
+        }
+
+        void start() {
+#ifdef __linux__
+            for(auto descriptor: descriptors){
+                if(descriptor >= 0){
+                    ioctl(descriptor, PERF_EVENT_IOC_RESET, 0); // NOLINT(cppcoreguidelines-pro-type-vararg)
+                    ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0); // NOLINT(cppcoreguidelines-pro-type-vararg)
+                }
+            }
+#endif
+            startTime = std::chrono::steady_clock::now();
+        }
+
+        Counts stop() {
+            Counts counts;
+            counts.elapsed = std::chrono::steady_clock::now() - startTime;
+#ifdef __linux__
+            for(size_t index = 0; index < descriptors.size(); ++index){
+                if(descriptors[index] < 0){
+                    continue;
+                }
+                ioctl(descriptors[index], PERF_EVENT_IOC_DISABLE, 0); // NOLINT(cppcoreguidelines-pro-type-vararg)
+                uint64_t value = 0;
+                if(read(descriptors[index], &value, sizeof(value)) == sizeof(value)){
+                    counts.values[index] = value;
+                }
+            }
+#endif
+            return counts;
+        }
+
+    private:
+        static int open(Counter counter) {
+#ifdef __linux__
+            perf_event_attr attributes {};
+            attributes.size = sizeof(attributes);
+            attributes.disabled = 1;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            // Threads created while the counter is open get their own copy, and reading this one
+            // sums them in. Threads that already exist (a pool started by an earlier phase) aren't
+            // counted at all. The ioctls in start() reach the copies of live threads, but not counts
+            // already folded in from threads that exited. That's fine since every Phase opens new counters
+            attributes.inherit = 1;
+            switch(counter){
+                case Counter::Cycles: attributes.type = PERF_TYPE_HARDWARE; attributes.config = PERF_COUNT_HW_CPU_CYCLES; break;
+                case Counter::Instructions: attributes.type = PERF_TYPE_HARDWARE; attributes.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+                case Counter::L1DataMisses:
+                    attributes.type = PERF_TYPE_HW_CACHE;
+                    attributes.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8U) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);
+                    break;
+                case Counter::LastLevelCacheMisses: attributes.type = PERF_TYPE_HARDWARE; attributes.config = PERF_COUNT_HW_CACHE_MISSES; break;
+                case Counter::BranchMisses: attributes.type = PERF_TYPE_HARDWARE; attributes.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+            }
+            return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0)); // NOLINT(cppcoreguidelines-pro-type-vararg)
+#else
+            (void)counter;
+            return -1;
+#endif
+        }
+
+        std::array<int, allCounters.size()> descriptors {};
+        std::chrono::steady_clock::time_point startTime;
+    };
+
+    void report(std::ostream& stream, const std::string& name, const Counts& counts) {
+        auto print = [&stream, &counts](const char* label, Counter counter){
+            stream << ", " << label << " ";
+            if(auto value = counts[counter]){
+                stream << *value;
+            }
+            else {
+                stream << "n/a";
+            }
+        };
+        const auto flags = stream.flags();
+        const auto precision = stream.precision();
+        stream << "[perf] " << name << ": " << std::fixed << std::setprecision(3) << counts.elapsed.count() << " ms";
+        print("cycles", Counter::Cycles);
+        print("instructions", Counter::Instructions);
+        if(counts[Counter::Cycles] && counts[Counter::Instructions] && *counts[Counter::Cycles] != 0){
+            stream << " (IPC " << std::setprecision(2) << static_cast<double>(*counts[Counter::Instructions]) / static_cast<double>(*counts[Counter::Cycles]) << ")";
+        }
+        print("L1d misses", Counter::L1DataMisses);
+        print("LLC misses", Counter::LastLevelCacheMisses);
+        print("branch misses", Counter::BranchMisses);
+        stream << "\n";
+        stream.flags(flags);
+        stream.precision(precision);
+    }
+
+    // counts from construction to destruction, reports to stderr so stdout stays just the answers
+    class Phase {
+    public:
+        explicit Phase(std::string name) : name(std::move(name)) {
+            if(isEnabled()){
+                counters.emplace();
+                counters->start();
+            }
+        }
+
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+        ~Phase() {
+            if(counters){
+                report(std::cerr, name, counters->stop());
+            }
+        }
+
+    private:
+        std::string name;
+        std::optional<Counters> counters;
+    };
+
+    // run func as its own phase and hand back whatever it returns
+    template <typename Func>
+    auto measure(const std::string& name, Func func) {
+        const Phase phase(name);
+        return func();
+    }
+} // namespace perf
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace rope {
+
+    // Sequences that can be cut and glued back together in O(log n), reversed in O(1) and
+    // only walked element by element when asked. Every sequence is an implicit treap:
+    // a binary tree ordered by position, kept balanced by random heap priorities,
+    // with a lazy "reversed" flag pushed down only when a split or merge looks inside.
+    //
+    // All sequences live in one Forest so their nodes share storage and moving
+    // a piece from one sequence to another never copies an element
+    template <typename T>
+    class Forest {
+    public:
+        using Handle = uint32_t;
+        static constexpr Handle empty = 0;
+
+        Forest() {
+            nodes.emplace_back(); // slot 0 stands in for "no node"
+        }
+
+        Handle create(std::span<const T> values) {
+            nodes.reserve(nodes.size() + values.size());
+            Handle sequence = empty;
+            for(const auto& value: values){
+                sequence = merge(sequence, createNode(value));
+            }
+            return sequence;
+        }
+
+        size_t size(Handle sequence) const {
+            return nodes[sequence].size;
+        }
+
+        // first `count` elements, then the rest
+        std::pair<Handle, Handle> split(Handle sequence, size_t count) {
+            if(sequence == empty){
+                return {empty, empty};
+            }
+            pushDown(sequence);
+            auto& node = nodes[sequence];
+            auto leftSize = nodes[node.left].size;
+            if(count <= leftSize){
+                auto [first, rest] = split(node.left, count);
+                nodes[sequence].left = rest;
+                update(sequence);
+                return {first, sequence};
+            }
+            auto [first, rest] = split(node.right, count - leftSize - 1);
+            nodes[sequence].right = first;
+            update(sequence);
+            return {sequence, rest};
+        }
+
+        // lhs followed by rhs
+        Handle merge(Handle lhs, Handle rhs) {
+            if(lhs == empty || rhs == empty){
+                return lhs == empty ? rhs : lhs;
+            }
+            if(nodes[lhs].priority > nodes[rhs].priority){
+                pushDown(lhs);
+                auto right = merge(nodes[lhs].right, rhs);
+                nodes[lhs].right = right;
+                update(lhs);
+                return lhs;
+            }
+            pushDown(rhs);
+            auto left = merge(lhs, nodes[rhs].left);
+            nodes[rhs].left = left;
+            update(rhs);
+            return rhs;
+        }
+
+        void reverse(Handle sequence) {
+            if(sequence != empty){
+                nodes[sequence].reversed = !nodes[sequence].reversed;
+            }
+        }
+
+        // last element, without touching any flags
+        const T& back(Handle sequence) const {
+            assert(sequence != empty);
+            bool reversed = false;
+            while(true){
+                const auto& node = nodes[sequence];
+                reversed = reversed != node.reversed;
+                auto next = reversed ? node.left : node.right;
+                if(next == empty){
+                    return node.value;
+                }
+                sequence = next;
+            }
+        }
+
+        std::vector<T> toVector(Handle sequence) {
+            std::vector<T> out;
+            out.reserve(size(sequence));
+            appendTo(sequence, out);
+            return out;
+        }
+
+    private:
+        struct Node {
+            T value {};
+            uint64_t priority = 0;
+            uint32_t size = 0;
+            Handle left = empty;
+            Handle right = empty;
+            bool reversed = false;
+        };
+
+        Handle createNode(const T& value) {
+            // xorshift, plenty random enough to keep the tree balanced
+            seed ^= seed << 13U;
+            seed ^= seed >> 7U;
+            seed ^= seed << 17U;
+            Node node;
+            node.value = value;
+            node.priority = seed;
+            node.size = 1;
+            nodes.push_back(node);
+            return static_cast<Handle>(nodes.size() - 1);
+        }
+
+        void pushDown(Handle sequence) {
+            auto& node = nodes[sequence];
+            if(node.reversed){
+                std::swap(node.left, node.right);
+                reverse(node.left);
+                reverse(node.right);
+                node.reversed = false;
+            }
+        }
+
+        void update(Handle sequence) {
+            auto& node = nodes[sequence];
+            node.size = nodes[node.left].size + nodes[node.right].size + 1;
+        }
+
+        void appendTo(Handle sequence, std::vector<T>& out) {
+            if(sequence == empty){
+                return;
+            }
+            pushDown(sequence);
+            appendTo(nodes[sequence].left, out);
+            out.push_back(nodes[sequence].value);
+            appendTo(nodes[sequence].right, out);
+        }
+
+        std::vector<Node> nodes;
+        uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    };
+} // namespace rope
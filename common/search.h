@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "hash.h"
+#include "parallel.h"
+
+namespace search {
+
+    struct Options {
+        // keep only this many of the highest valued states after each step, 0 keeps everything
+        size_t beamWidth = 0;
+        bool parallel = true;
+    };
+
+    // no pruning at all
+    struct NoBound {
+        template <typename State, typename Value>
+        Value operator()(const State&, const Value&) const {
+            return std::numeric_limits<Value>::max();
+        }
+    };
+
+    // Advances a whole frontier of states one time step at a time.
+    // Every state carries a value that it is guaranteed to end up with (flow released so far,
+    // geodes already paid for...). When two paths reach the same state only the larger value is kept.
+    //
+    // Each step:
+    //   - states whose upper bound can't beat the best value seen so far get dropped
+    //   - the rest are expanded in parallel chunks, each chunk sharding what it emits by hash
+    //   - every shard is deduplicated in its own flat hash table, also in parallel
+    template <typename State, typename Value, typename HashFunc = hash::Hash<State>>
+    class LevelSearch {
+    public:
+        using Entry = std::pair<State, Value>;
+
+        LevelSearch(std::vector<Entry> initial, Options options = {}) : frontier(std::move(initial)), options(options) {
+            for(const auto& [_, value]: frontier){
+                bestValue = std::max(bestValue, value);
+            }
+        }
+
+        LevelSearch(State initial, Value value, Options options = {}) : LevelSearch(std::vector<Entry>{{std::move(initial), value}}, options) {}
+
+        // expand(state, value, emit) calls emit(newState, newValue) for every successor,
+        // include the state itself if standing still is allowed
+        // bound(state, value) returns the most value the state could possibly end up with
+        template <typename Expand, typename Bound = NoBound>
+        void advance(Expand expand, Bound bound = {}) {
+            auto& pool = parallel::getPool();
+            const bool isParallel = options.parallel && pool.size() > 1 && frontier.size() > minimumParallelFrontier;
+            const size_t numberOfShards = isParallel ? pool.size() : 1;
+            const size_t numberOfChunks = isParallel ? pool.size() * 4 : 1;
+            const size_t chunkSize = (frontier.size() + numberOfChunks - 1) / numberOfChunks;
+
+            // buckets[chunk * numberOfShards + shard]
+            std::vector<std::vector<Entry>> buckets(numberOfChunks * numberOfShards);
+            auto expandChunk = [&](size_t chunk){
+                auto* chunkBuckets = &buckets[chunk * numberOfShards];
+                auto emit = [chunkBuckets, numberOfShards](State state, Value value){
+                    auto shard = (HashFunc{}(state) >> 32U) % numberOfShards;
+                    chunkBuckets[shard].emplace_back(std::move(state), value); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                };
+                auto end = std::min(frontier.size(), (chunk + 1) * chunkSize);
+                for(auto index = chunk * chunkSize; index < end; ++index){
+                    const auto& [state, value] = frontier[index];
+                    if(bound(state, value) < bestValue){
+                        continue;
+                    }
+                    expand(state, value, emit);
+                }
+            };
+
+            std::vector<std::vector<Entry>> shards(numberOfShards);
+            std::vector<Value> shardBest(numberOfShards, bestValue);
+            auto mergeShard = [&](size_t shard){
+                hash::FlatMap<State, Value, HashFunc> seen;
+                for(size_t chunk = 0; chunk < numberOfChunks; ++chunk){
+                    for(auto& [state, value]: buckets[chunk * numberOfShards + shard]){
+                        auto [match, inserted] = seen.try_emplace(state, value);
+                        if(!inserted){
+                            match->second = std::max(match->second, value);
+                        }
+                    }
+                }
+                shards[shard].reserve(seen.size());
+                for(const auto& [state, value]: seen){
+                    shardBest[shard] = std::max(shardBest[shard], value);
+                    shards[shard].emplace_back(state, value);
+                }
+            };
+
+            if(isParallel){
+                parallel::parallelFor(0, numberOfChunks, expandChunk, 1, pool);
+                parallel::parallelFor(0, numberOfShards, mergeShard, 1, pool);
+            }
+            else {
+                expandChunk(0);
+                mergeShard(0);
+            }
+
+            frontier.clear();
+            for(size_t shard = 0; shard < numberOfShards; ++shard){
+                bestValue = std::max(bestValue, shardBest[shard]);
+                std::ranges::move(shards[shard], std::back_inserter(frontier));
+            }
+
+            if(options.beamWidth != 0 && frontier.size() > options.beamWidth){
+                std::ranges::nth_element(frontier, frontier.begin() + static_cast<std::ptrdiff_t>(options.beamWidth), [](const Entry& lhs, const Entry& rhs){
+                    return lhs.second > rhs.second;
+                });
+                frontier.erase(frontier.begin() + static_cast<std::ptrdiff_t>(options.beamWidth), frontier.end());
+            }
+        }
+
+        const std::vector<Entry>& getFrontier() const {
+            return frontier;
+        }
+
+        // best value of any state seen so far
+        Value getBest() const {
+            return bestValue;
+        }
+
+    private:
+        // below this, spinning up tasks costs more than it saves
+        static constexpr size_t minimumParallelFrontier = 1024;
+
+        std::vector<Entry> frontier;
+        Options options;
+        Value bestValue = std::numeric_limits<Value>::lowest();
+    };
+} // namespace search
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+
+namespace topk {
+
+    // Keeps the k largest values pushed so far (largest by Compare, so std::greater keeps the k smallest).
+    // A k-sized heap with the weakest kept value on top: O(log k) per push, O(k) memory however many go by
+    template <typename T, typename Compare = std::less<T>>
+    class TopK {
+    public:
+        explicit TopK(size_t k, Compare compare = {}) : k(k), compare(compare) {
+            heap.reserve(k);
+        }
+
+        void push(T value) {
+            if(k == 0){
+                return;
+            }
+            if(heap.size() < k){
+                heap.push_back(std::move(value));
+                std::ranges::push_heap(heap, inverted());
+            }
+            else if(compare(heap.front(), value)){
+                std::ranges::pop_heap(heap, inverted());
+                heap.back() = std::move(value);
+                std::ranges::push_heap(heap, inverted());
+            }
+        }
+
+        void merge(const TopK& other) {
+            for(const auto& value: other.heap){
+                push(value);
+            }
+        }
+
+        // best first
+        std::vector<T> getSorted() const {
+            auto sorted = heap;
+            std::ranges::sort(sorted, [this](const T& lhs, const T& rhs){ return compare(rhs, lhs); });
+            return sorted;
+        }
+
+        size_t size() const {
+            return heap.size();
+        }
+
+        size_t capacity() const {
+            return k;
+        }
+
+    private:
+        // heap functions keep the largest on top, we want the weakest
+        auto inverted() const {
+            return [this](const T& lhs, const T& rhs){ return compare(rhs, lhs); };
+        }
+
+        size_t k;
+        Compare compare;
+        std::vector<T> heap;
+    };
+
+    // top k of values that come in chunks: produce(chunk, push) calls push(value) for every value in that chunk.
+    // Every chunk fills its own heap on the thread pool, then they're merged
+    template <typename T, typename Compare = std::less<T>, typename Produce>
+    TopK<T, Compare> parallelTopK(size_t numberOfChunks, size_t k, Produce produce, Compare compare = {}, parallel::ThreadPool& pool = parallel::getPool()) {
+        std::vector<TopK<T, Compare>> partials(numberOfChunks, TopK<T, Compare>(k, compare));
+        parallel::parallelFor(0, numberOfChunks, [&](size_t chunk){
+            produce(chunk, [&partial = partials[chunk]](T value){ partial.push(std::move(value)); });
+        }, 1, pool);
+        TopK<T, Compare> result(k, compare);
+        for(const auto& partial: partials){
+            result.merge(partial);
+        }
+        return result;
+    }
+} // namespace topk